@@ -0,0 +1,141 @@
+#include "common.hpp"
+#include "lsdb-diff.hpp"
+#include "name-trie.hpp"
+
+#include <chrono>
+
+namespace ndn6::bench_lsdb_diff {
+
+using Clock = std::chrono::steady_clock;
+
+static double
+millisSince(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static Block
+makeLsa(size_t router, uint64_t seq, size_t nNames, size_t variant) {
+  Block info(LsdbDiff::TtLsa);
+  info.push_back(Name("/net").appendNumber(router).wireEncode());
+  info.push_back(ndn::encoding::makeNonNegativeIntegerBlock(0x82, seq));
+  info.encode();
+
+  Block lsa(0x89);
+  lsa.push_back(info);
+  for (size_t i = 0; i < nNames; ++i) {
+    Block prefixInfo(LsdbDiff::TtPrefixInfo);
+    prefixInfo.push_back(
+      Name("/net").appendNumber(router).append("p").appendNumber(i + variant).wireEncode());
+    prefixInfo.encode();
+    lsa.push_back(prefixInfo);
+  }
+  lsa.encode();
+  return lsa;
+}
+
+// Previous approach: decode every LSA, then filter each name linearly.
+static size_t
+fullParse(const std::vector<Block>& lsas, const std::vector<Name>& filters) {
+  std::set<Name> names;
+  for (const auto& lsa : lsas) {
+    lsa.parse();
+    for (const auto& element : lsa.elements()) {
+      if (element.type() == LsdbDiff::TtPrefixInfo) {
+        element.parse();
+        names.emplace(element.get(tlv::Name));
+      }
+    }
+  }
+  size_t nAccepted = 0;
+  for (const auto& name : names) {
+    nAccepted += static_cast<size_t>(std::any_of(
+      filters.begin(), filters.end(), [&](const Name& prefix) { return prefix.isPrefixOf(name); }));
+  }
+  return nAccepted;
+}
+
+int
+main(int argc, char** argv) {
+  size_t nRouters = 1000;
+  size_t nNamesPerRouter = 100;
+  size_t nFilters = 100;
+  size_t nChanged = 10;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: bench-lsdb-diff\n"
+    "\n"
+    "Measure convergence time of NLSR names dataset diffing.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("routers", po::value(&nRouters), "number of NameLSAs");
+      addOption("names", po::value(&nNamesPerRouter), "names per NameLSA");
+      addOption("filters", po::value(&nFilters), "readvertise filter prefixes");
+      addOption("changed", po::value(&nChanged), "NameLSAs changed per update");
+    });
+
+  std::vector<Name> filters;
+  NameTrie trie;
+  for (size_t i = 0; i < nFilters; ++i) {
+    filters.push_back(Name("/net").appendNumber(i * 2));
+    trie.insert(filters.back());
+  }
+
+  auto makeDataset = [&](uint64_t seq, size_t nVariant) {
+    std::vector<Block> lsas;
+    for (size_t r = 0; r < nRouters; ++r) {
+      lsas.push_back(makeLsa(r, seq, nNamesPerRouter, r < nVariant ? 1 : 0));
+    }
+    return lsas;
+  };
+  auto initial = makeDataset(1, 0);
+  auto refreshed = makeDataset(2, 0);
+  auto changed = makeDataset(3, nChanged);
+
+  LsdbDiff diff;
+  size_t nAdvertise = 0, nWithdraw = 0;
+  auto onAdvertise = [&](const Name& name) {
+    nAdvertise += static_cast<size_t>(trie.covers(name));
+  };
+  auto onWithdraw = [&](const Name& name) {
+    nWithdraw += static_cast<size_t>(trie.covers(name));
+  };
+
+  auto report = [&](const char* scenario, double ms) {
+    std::cout << scenario << "-ms\t" << ms << '\n'
+              << scenario << "-parsed\t" << diff.getParsedCount() << '\n'
+              << scenario << "-skipped\t" << diff.getSkippedCount() << '\n'
+              << scenario << "-advertise\t" << nAdvertise << '\n'
+              << scenario << "-withdraw\t" << nWithdraw << std::endl;
+    nAdvertise = nWithdraw = 0;
+  };
+
+  std::cout << "names\t" << nRouters * nNamesPerRouter << std::endl;
+
+  auto t0 = Clock::now();
+  diff.apply(initial, onAdvertise, onWithdraw);
+  report("initial", millisSince(t0));
+
+  t0 = Clock::now();
+  diff.apply(refreshed, onAdvertise, onWithdraw);
+  report("unchanged", millisSince(t0));
+
+  t0 = Clock::now();
+  diff.apply(changed, onAdvertise, onWithdraw);
+  report("changed", millisSince(t0));
+
+  // separate dataset, so that no LSA has been parsed beforehand
+  auto baseline = makeDataset(4, nChanged);
+  t0 = Clock::now();
+  size_t nAccepted = fullParse(baseline, filters);
+  double fullParseMs = millisSince(t0);
+  std::cout << "full-parse-ms\t" << fullParseMs << '\n'
+            << "full-parse-accepted\t" << nAccepted << std::endl;
+  return 0;
+}
+
+} // namespace ndn6::bench_lsdb_diff
+
+int
+main(int argc, char** argv) {
+  return ndn6::bench_lsdb_diff::main(argc, argv);
+}
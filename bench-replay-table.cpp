@@ -0,0 +1,93 @@
+#include "common.hpp"
+#include "replay-table.hpp"
+
+#include <chrono>
+#include <random>
+#include <sys/resource.h>
+
+namespace ndn6::bench_replay_table {
+
+using Clock = std::chrono::steady_clock;
+
+static long
+maxRssKib() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+static double
+nanosPerOp(Clock::time_point t0, Clock::time_point t1, size_t nOps) {
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / nOps;
+}
+
+int
+main(int argc, char** argv) {
+  size_t nSigners = 1000000;
+  size_t capacity = 0;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: bench-replay-table\n"
+    "\n"
+    "Measure memory and lookup cost of the prefix-proxy replay table.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("signers", po::value(&nSigners), "number of distinct signers");
+      addOption("capacity", po::value(&capacity), "table capacity, default is 2x signers");
+    });
+  if (capacity == 0) {
+    capacity = 2 * nSigners;
+  }
+
+  std::mt19937_64 rng(0x5EED);
+  std::vector<uint64_t> keys(nSigners);
+  for (auto& key : keys) {
+    key = rng();
+  }
+
+  long rss0 = maxRssKib();
+  ReplayTable table(capacity);
+
+  auto t0 = Clock::now();
+  for (size_t i = 0; i < nSigners; ++i) {
+    table.insert(keys[i], i);
+  }
+  auto t1 = Clock::now();
+
+  std::shuffle(keys.begin(), keys.end(), rng);
+  size_t nHits = 0;
+  auto t2 = Clock::now();
+  for (auto key : keys) {
+    nHits += static_cast<size_t>(table.find(key).has_value());
+  }
+  auto t3 = Clock::now();
+
+  size_t nMisses = 0;
+  auto t4 = Clock::now();
+  for (size_t i = 0; i < nSigners; ++i) {
+    nMisses += static_cast<size_t>(!table.find(rng()).has_value());
+  }
+  auto t5 = Clock::now();
+  long rss1 = maxRssKib();
+
+  std::cout << "signers\t" << nSigners << '\n'
+            << "capacity\t" << table.capacity() << '\n'
+            << "size\t" << table.size() << '\n'
+            << "evictions\t" << table.nEvictions() << '\n'
+            << "retained\t" << static_cast<double>(nHits) / nSigners << '\n'
+            << "memory-bytes\t" << table.memoryUsage() << '\n'
+            << "bytes-per-signer\t" << static_cast<double>(table.memoryUsage()) / nSigners << '\n'
+            << "rss-growth-kib\t" << rss1 - rss0 << '\n'
+            << "insert-ns\t" << nanosPerOp(t0, t1, nSigners) << '\n'
+            << "lookup-hit-ns\t" << nanosPerOp(t2, t3, nSigners) << '\n'
+            << "lookup-miss-ns\t" << nanosPerOp(t4, t5, nSigners) << '\n'
+            << "miss-correct\t" << static_cast<double>(nMisses) / nSigners << std::endl;
+  return 0;
+}
+
+} // namespace ndn6::bench_replay_table
+
+int
+main(int argc, char** argv) {
+  return ndn6::bench_replay_table::main(argc, argv);
+}
@@ -0,0 +1,338 @@
+#include "common.hpp"
+#include "file-server.hpp"
+#include "prefix-proxy.hpp"
+#include "serve-certs.hpp"
+#include "unix-time.hpp"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+
+// Count heap allocations of the whole process.
+static std::atomic<uint64_t> nAllocs{0};
+
+void*
+operator new(size_t size) {
+  nAllocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size); p != nullptr) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void
+operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace ndn6::bench_services {
+
+using Clock = std::chrono::steady_clock;
+using ndn::DummyClientFace;
+
+// Discard log lines printed by services, so that the benchmark measures formatting but not I/O.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override {
+    return c;
+  }
+};
+
+// Drive a handler on a DummyClientFace, one request at a time, and print Interests per second,
+// latency percentiles, and heap allocations per request. Latency is measured from Interest
+// arrival to the reply leaving the face, including event loop rounds in between.
+class Runner {
+public:
+  explicit Runner(std::ostream& os, double duration)
+    : m_os(os)
+    , m_duration(duration) {}
+
+  // Process pending events, such as prefix registration replies.
+  static void settle(DummyClientFace& face) {
+    auto& io = face.getIoContext();
+    for (int i = 0; i < 16; ++i) {
+      io.restart();
+      if (io.poll() == 0) {
+        break;
+      }
+    }
+  }
+
+  template<typename MakeRequest>
+  void run(const char* scenario, DummyClientFace& face, const MakeRequest& makeRequest) {
+    settle(face);
+    uint64_t nReplies = 0;
+    ndn::signal::ScopedConnection conn =
+      face.onSendData.connect([&](const Data&) { ++nReplies; });
+    auto& io = face.getIoContext();
+
+    std::vector<double> latencies;
+    latencies.reserve(1 << 20);
+    uint64_t allocs = 0;
+    size_t nUnanswered = 0;
+    auto start = Clock::now();
+    Clock::duration busy{};
+    for (size_t i = 0; std::chrono::duration<double>(Clock::now() - start).count() < m_duration &&
+                       latencies.size() < latencies.capacity();
+         ++i) {
+      Interest interest = makeRequest(i);
+      uint64_t want = nReplies + 1;
+
+      uint64_t allocs0 = nAllocs.load(std::memory_order_relaxed);
+      auto t0 = Clock::now();
+      face.receive(interest);
+      for (int round = 0; nReplies < want && round < 64; ++round) {
+        io.restart();
+        io.poll();
+      }
+      auto t1 = Clock::now();
+      allocs += nAllocs.load(std::memory_order_relaxed) - allocs0;
+
+      nUnanswered += static_cast<size_t>(nReplies < want);
+      busy += t1 - t0;
+      latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+      face.sentData.clear();
+    }
+
+    size_t n = latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+      return n == 0 ? 0.0 : latencies[std::min(n - 1, static_cast<size_t>(n * p))];
+    };
+    m_allocs[scenario] = static_cast<double>(allocs) / n;
+    m_os << scenario << "-requests\t" << n << '\n'
+         << scenario << "-interests-per-second\t"
+         << n / std::chrono::duration<double>(busy).count() << '\n'
+         << scenario << "-p50-us\t" << percentile(0.50) << '\n'
+         << scenario << "-p99-us\t" << percentile(0.99) << '\n'
+         << scenario << "-allocs-per-request\t" << m_allocs[scenario] << '\n'
+         << scenario << "-unanswered\t" << nUnanswered << '\n';
+  }
+
+  double allocsPerRequest(const std::string& scenario) const {
+    return m_allocs.at(scenario);
+  }
+
+private:
+  std::ostream& m_os;
+  double m_duration;
+  std::map<std::string, double> m_allocs;
+};
+
+// Reply to the same Interests as file-server without reading files, to measure allocations made
+// by ndn-cxx for each reply: "floor-sign" builds and signs a segment, "floor-put" sends a prepared
+// segment. The Interests must be the same, because decoding cost depends on the name.
+template<typename MakeRequest>
+static void
+benchFloor(Runner& runner, KeyChain& keyChain, const Name& prefix, size_t segmentSize,
+           uint64_t lastSeg, const MakeRequest& makeRequest) {
+  DummyClientFace face(keyChain, {false, true});
+  CachedSigner signer(keyChain);
+  std::vector<uint8_t> payload(segmentSize, 'B');
+  Data prepared(makeRequest(0).getName());
+  prepared.setFinalBlock(name::Component::fromSegment(lastSeg));
+  prepared.setContent(payload);
+  signer.sign(prepared);
+
+  bool isPrepared = false;
+  face.setInterestFilter(prefix, [&](const ndn::InterestFilter&, const Interest& interest) {
+    if (isPrepared) {
+      face.put(prepared);
+      return;
+    }
+    Data data(interest.getName());
+    data.setFinalBlock(name::Component::fromSegment(lastSeg));
+    data.setContent(payload);
+    signer.sign(data);
+    face.put(data);
+  });
+
+  runner.run("floor-sign", face, makeRequest);
+  isPrepared = true;
+  runner.run("floor-put", face, makeRequest);
+}
+
+static void
+benchFileServer(Runner& runner, KeyChain& keyChain, int manifestSegments, size_t cacheSegments) {
+  namespace fs = file_server::fs;
+  fs::path dir = fs::temp_directory_path() / fs::unique_path("bench-services-%%%%%%%%");
+  fs::create_directory(dir);
+  {
+    std::ofstream file((dir / "bench.bin").string(), std::ios::binary);
+    std::string chunk(65536, 'B');
+    for (int i = 0; i < 16; ++i) {
+      file << chunk;
+    }
+  }
+
+  DummyClientFace face(keyChain, {false, true});
+  file_server::Options opts;
+  opts.servePrefix = opts.discoveryPrefix = "/bench/files";
+  opts.directory = dir;
+  opts.manifestSegments = manifestSegments;
+  opts.cacheSegments = cacheSegments;
+  file_server::FileServer app(face, keyChain, opts);
+  app.start();
+
+  Name metadataName("/bench/files/bench.bin/32=metadata");
+  Name versioned;
+  {
+    ndn::signal::ScopedConnection conn = face.onSendData.connect([&](const Data& data) {
+      data.getContent().parse();
+      versioned.wireDecode(data.getContent().get(tlv::Name));
+    });
+    Runner::settle(face);
+    face.receive(Interest(metadataName).setCanBePrefix(true).setMustBeFresh(true));
+    Runner::settle(face);
+  }
+  uint64_t nSegments = file_server::SegmentLimit::computeLastSeg(16 * 65536, opts.segmentSize) + 1;
+
+  auto makeSegmentInterest = [&](size_t i) {
+    return Interest(Name(versioned).appendSegment(i % nSegments));
+  };
+
+  if (manifestSegments > 0) {
+    // segment Interests are interleaved with manifest Interests at the rate a consumer needs them
+    runner.run("file-server-manifest-segment", face, [&](size_t i) {
+      uint64_t seg = i % nSegments;
+      if (seg % manifestSegments == 0) {
+        return Interest(Name(versioned)
+                          .append(file_server::manifestComponent)
+                          .appendSegment(seg / manifestSegments));
+      }
+      return makeSegmentInterest(seg);
+    });
+  } else if (cacheSegments > 0) {
+    // fill the cache, so that every measured request is a cache hit
+    for (uint64_t i = 0; i < nSegments; ++i) {
+      face.receive(makeSegmentInterest(i));
+      Runner::settle(face);
+    }
+    runner.run("file-server-segment-cached", face, makeSegmentInterest);
+  } else {
+    runner.run("file-server-metadata", face, [&](size_t) {
+      return Interest(metadataName).setCanBePrefix(true).setMustBeFresh(true);
+    });
+    runner.run("file-server-segment", face, makeSegmentInterest);
+    benchFloor(runner, keyChain, opts.servePrefix, opts.segmentSize, nSegments - 1,
+               makeSegmentInterest);
+  }
+
+  fs::remove_all(dir);
+}
+
+static void
+benchServeCerts(Runner& runner, KeyChain& keyChain, const Certificate& cert) {
+  DummyClientFace face(keyChain, {false, true});
+  serve_certs::Options opts;
+  opts.certs.push_back(cert);
+  Scheduler sched(face.getIoContext());
+  serve_certs::ServeCerts app(face, keyChain, sched, opts);
+  app.start();
+
+  runner.run("serve-certs", face, [&](size_t) { return Interest(cert.getName()); });
+  runner.run("serve-certs-chain", face, [&](size_t) {
+    return Interest(Name(cert.getKeyName()).append(serve_certs::chainComponent))
+      .setCanBePrefix(true)
+      .setMustBeFresh(true);
+  });
+}
+
+static void
+benchUnixTime(Runner& runner, KeyChain& keyChain, int granularity, const char* scenario) {
+  DummyClientFace face(keyChain, {false, true});
+  unix_time::Options opts;
+  opts.granularity = granularity;
+  Scheduler sched(face.getIoContext());
+  unix_time::UnixTimeService app(face, keyChain, sched, opts);
+  app.start();
+
+  runner.run(scenario, face, [&](size_t) {
+    return Interest("/localhop/unix-time").setCanBePrefix(true).setMustBeFresh(true);
+  });
+}
+
+static void
+benchPrefixProxy(Runner& runner, KeyChain& keyChain, const ndn::security::Identity& identity) {
+  DummyClientFace face(keyChain, {false, true});
+  prefix_proxy::Options opts;
+  opts.anchors.emplace_back("bench", identity.getDefaultKey().getDefaultCertificate());
+  prefix_proxy::PrefixProxy app(face, keyChain, opts);
+  app.start();
+
+  // commands are signed before arrival, because signing is done by the client
+  InterestSigner signer(keyChain);
+  auto si = ndn::signingByIdentity(identity);
+  runner.run("prefix-proxy-register", face, [&](size_t i) {
+    nfd::ControlParameters params;
+    params.setName(Name(identity.getName()).append("p").appendNumber(i));
+    auto interest = nfd::RibRegisterCommand::createRequest(opts.listenPrefix, params);
+    signer.makeSignedInterest(interest, si);
+    interest.setTag(std::make_shared<lp::IncomingFaceIdTag>(256));
+    return interest;
+  });
+}
+
+int
+main(int argc, char** argv) {
+  double duration = 1.0;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: bench-services\n"
+    "\n"
+    "Measure request handling of services on an in-process face.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("duration", po::value(&duration), "duration of each scenario (seconds)");
+    });
+
+  // in-memory keys, so that the benchmark does not touch the user's KeyChain
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  auto identity = keyChain.createIdentity("/bench");
+
+  NullBuffer nullBuffer;
+  std::ostream results(std::cout.rdbuf());
+  std::cout.rdbuf(&nullBuffer);
+  Runner runner(results, duration);
+
+  benchFileServer(runner, keyChain, 0, 0);
+  benchFileServer(runner, keyChain, 0, 4096);
+  benchFileServer(runner, keyChain, 128, 0);
+  benchServeCerts(runner, keyChain, identity.getDefaultKey().getDefaultCertificate());
+  benchUnixTime(runner, keyChain, 0, "unix-time-sign-each");
+  benchUnixTime(runner, keyChain, 10, "unix-time-presigned");
+  benchPrefixProxy(runner, keyChain, identity);
+
+  // file-server must not allocate beyond what ndn-cxx needs for the reply; a fraction of an
+  // allocation per request is tolerated, for one-time growth of reused buffers
+  int exitCode = 0;
+  for (auto [scenario, baseline] : {std::pair("file-server-segment", "floor-sign"),
+                                    std::pair("file-server-segment-cached", "floor-put")}) {
+    double extra = runner.allocsPerRequest(scenario) - runner.allocsPerRequest(baseline);
+    results << scenario << "-extra-allocs\t" << extra << '\n';
+    if (extra >= 0.5) {
+      std::cerr << scenario << " allocates more than " << baseline << std::endl;
+      exitCode = 1;
+    }
+  }
+
+  std::cout.rdbuf(results.rdbuf());
+  std::cout.flush();
+  return exitCode;
+}
+
+} // namespace ndn6::bench_services
+
+int
+main(int argc, char** argv) {
+  return ndn6::bench_services::main(argc, argv);
+}
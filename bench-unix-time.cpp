@@ -0,0 +1,99 @@
+#include "common.hpp"
+#include "unix-time.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace ndn6::bench_unix_time {
+
+using unix_time::PresignedAnswers;
+using Clock = std::chrono::steady_clock;
+
+static double
+secondsSince(Clock::time_point t0) {
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+int
+main(int argc, char** argv) {
+  int granularity = 10;
+  size_t signAhead = 4;
+  double duration = 2.0;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: bench-unix-time\n"
+    "\n"
+    "Measure reply rate and timestamp error of unix-time-service answers.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("granularity", po::value(&granularity), "tick granularity (milliseconds)");
+      addOption("sign-ahead", po::value(&signAhead), "ticks signed ahead in background");
+      addOption("duration", po::value(&duration), "duration of each scenario (seconds)");
+    });
+
+  // in-memory keys, so that the benchmark does not touch the user's KeyChain
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  auto identity = keyChain.createIdentity("/bench-unix-time");
+  auto si = ndn::signingByIdentity(identity);
+  auto safeBag = keyChain.exportSafeBag(identity.getDefaultKey().getDefaultCertificate(), "B", 1);
+  auto makeKeyChain = [&] {
+    auto kc = std::make_unique<KeyChain>("pib-memory:", "tpm-memory:");
+    kc->importSafeBag(*safeBag, "B", 1);
+    return kc;
+  };
+  Name prefix("/localhop/unix-time");
+
+  // measure replies per second and timestamp error of a reply function
+  auto run = [&](const char* scenario, const auto& makeReply) {
+    size_t nReplies = 0;
+    double errorSum = 0, errorMax = 0;
+    auto t0 = Clock::now();
+    while (secondsSince(t0) < duration) {
+      auto now = time::system_clock::now();
+      auto data = makeReply(now);
+      nReplies += static_cast<size_t>(data->wireEncode().size() > 0);
+      auto error =
+        time::duration_cast<time::microseconds>(now - data->getName().at(-1).toTimestamp());
+      double errorMs = std::abs(error.count()) / 1000.0;
+      errorSum += errorMs;
+      errorMax = std::max(errorMax, errorMs);
+    }
+    double elapsed = secondsSince(t0);
+    std::cout << scenario << "-replies-per-second\t" << nReplies / elapsed << '\n'
+              << scenario << "-error-mean-ms\t" << errorSum / nReplies << '\n'
+              << scenario << "-error-max-ms\t" << errorMax << '\n';
+  };
+
+  std::cout << "granularity-ms\t" << granularity << '\n' << "sign-ahead\t" << signAhead << '\n';
+
+  run("sign-each", [&](time::system_clock::time_point now) {
+    auto data = std::make_shared<Data>(Name(prefix).appendTimestamp(now));
+    data->setMetaInfo(ndn::MetaInfo().setFreshnessPeriod(1_ms));
+    keyChain.sign(*data, si);
+    return data;
+  });
+
+  {
+    PresignedAnswers presigned(keyChain, si, prefix, time::milliseconds(granularity));
+    run("presigned", [&](time::system_clock::time_point now) { return presigned.get(now); });
+    std::cout << "presigned-signed-inline\t" << presigned.getSignedInlineCount() << '\n';
+  }
+
+  if (signAhead > 0) {
+    PresignedAnswers presigned(keyChain, si, prefix, time::milliseconds(granularity));
+    presigned.startAhead(signAhead, makeKeyChain);
+    run("sign-ahead", [&](time::system_clock::time_point now) { return presigned.get(now); });
+    std::cout << "sign-ahead-signed-inline\t" << presigned.getSignedInlineCount() << '\n'
+              << "sign-ahead-signed-background\t" << presigned.getSignedAheadCount() << '\n';
+  }
+
+  std::cout.flush();
+  return 0;
+}
+
+} // namespace ndn6::bench_unix_time
+
+int
+main(int argc, char** argv) {
+  return ndn6::bench_unix_time::main(argc, argv);
+}
@@ -3,6 +3,7 @@
 
 #include <ndn-cxx/face.hpp>
 #include <ndn-cxx/lp/tags.hpp>
+#include <ndn-cxx/mgmt/dispatcher.hpp>
 #include <ndn-cxx/mgmt/nfd/control-command.hpp>
 #include <ndn-cxx/mgmt/nfd/controller.hpp>
 #include <ndn-cxx/mgmt/nfd/status-dataset.hpp>
@@ -18,16 +19,55 @@
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/variables_map.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <time.h>
 
 namespace ndn6 {
 
 namespace po = boost::program_options;
 
+// Startup phase timings, printed to stderr when NDN6_STARTUP_TIMING environment variable is set.
+// Each line has the phase name and milliseconds since static initialization of the program.
+class StartupTimer {
+public:
+  static void mark(const char* phase) {
+    static const bool isEnabled = std::getenv("NDN6_STARTUP_TIMING") != nullptr;
+    if (!isEnabled) {
+      return;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - s_t0;
+    std::cerr << "StartupTiming " << phase << " " << elapsed.count() << std::endl;
+  }
+
+private:
+  inline static const std::chrono::steady_clock::time_point s_t0 = std::chrono::steady_clock::now();
+};
+
+// Invalid command line arguments, or help request.
+class UsageError : public po::error {
+public:
+  explicit UsageError(const std::string& what, std::string usage, bool isHelp = false)
+    : po::error(what)
+    , usage(std::move(usage))
+    , isHelp(isHelp) {}
+
+public:
+  std::string usage; // usage text including options
+  bool isHelp;
+};
+
+// Parse program options. args excludes the program name.
+// Throws UsageError upon invalid arguments or --help, so that the caller can report which
+// configuration line it came from; standalone programs should use exitOnUsageError.
 inline po::variables_map
-parseProgramOptions(int argc, char** argv, const char* usage,
+parseProgramOptions(const std::vector<std::string>& args, const char* usage,
                     const std::function<void(po::options_description_easy_init)>& declare,
                     const char* positionalOption = nullptr, int positionalMax = -1) {
   po::options_description options("Options");
@@ -40,21 +80,57 @@ parseProgramOptions(int argc, char** argv, const char* usage,
     positional.add(positionalOption, positionalMax);
   }
 
+  auto makeUsage = [&] {
+    std::ostringstream os;
+    os << usage << options;
+    return os.str();
+  };
+
   po::variables_map vm;
-  po::store(po::command_line_parser(argc, argv).options(options).positional(positional).run(), vm);
   try {
+    po::store(po::command_line_parser(args).options(options).positional(positional).run(), vm);
+    if (vm.count("help") > 0) {
+      throw UsageError("help requested", makeUsage(), true);
+    }
     po::notify(vm);
-  } catch (const po::error&) {
-    std::cerr << usage << options;
-    std::exit(2);
+  } catch (const UsageError&) {
+    throw;
+  } catch (const std::exception& e) {
+    throw UsageError(e.what(), makeUsage());
   }
 
-  if (vm.count("help") > 0) {
-    std::cout << usage << options;
-    std::exit(0);
+  StartupTimer::mark("options");
+  return vm;
+}
+
+// Invoke f, which parses command line arguments. Upon UsageError, print usage and exit the
+// program with status 2, or 0 for --help.
+template<typename F>
+auto
+exitOnUsageError(const F& f) -> decltype(f()) {
+  try {
+    return f();
+  } catch (const UsageError& e) {
+    if (e.isHelp) {
+      std::cout << e.usage;
+      std::exit(0);
+    }
+    std::cerr << e.what() << std::endl;
+    if (!e.usage.empty()) {
+      std::cerr << '\n' << e.usage;
+    }
+    std::exit(2);
   }
+}
 
-  return vm;
+inline po::variables_map
+parseProgramOptions(int argc, char** argv, const char* usage,
+                    const std::function<void(po::options_description_easy_init)>& declare,
+                    const char* positionalOption = nullptr, int positionalMax = -1) {
+  return exitOnUsageError([&] {
+    return parseProgramOptions(std::vector<std::string>(argv + 1, argv + argc), usage, declare,
+                               positionalOption, positionalMax);
+  });
 }
 
 using namespace ndn::literals::time_literals;
@@ -79,12 +155,83 @@ using ndn::security::Certificate;
 using ndn::security::InterestSigner;
 using ndn::security::SigningInfo;
 
+// Process-wide KeyChain, opened on first use.
+// Pass it to Face constructor; otherwise, Face opens another KeyChain with its own PIB and TPM.
+inline KeyChain&
+getKeyChain() {
+  static std::unique_ptr<KeyChain> keyChain = [] {
+    auto kc = std::make_unique<KeyChain>();
+    StartupTimer::mark("keychain");
+    return kc;
+  }();
+  return *keyChain;
+}
+
+// Resolve signing by identity or by default identity to the identity's default key.
+// KeyChain::sign looks up the identity, key, and certificate in the PIB on every call, unless
+// SigningInfo refers to a key handle. If the lookup fails, si is returned unchanged, so that
+// KeyChain::sign reports the error or falls back to SHA-256 digest as before.
+inline SigningInfo
+resolveSigningKey(KeyChain& keyChain, const SigningInfo& si = SigningInfo()) {
+  SigningInfo resolved(si);
+  try {
+    switch (si.getSignerType()) {
+      case SigningInfo::SIGNER_TYPE_NULL:
+        resolved.setPibKey(keyChain.getPib().getDefaultIdentity().getDefaultKey());
+        break;
+      case SigningInfo::SIGNER_TYPE_ID:
+        resolved.setPibKey(keyChain.getPib().getIdentity(si.getSignerName()).getDefaultKey());
+        break;
+      default:
+        break;
+    }
+  } catch (const ndn::security::pib::Pib::Error&) {
+  }
+  return resolved;
+}
+
+// Signer that resolves its key upon the first signature, and reuses the key handle afterwards.
+// A change of default key after the first signature is not noticed until restart.
+class CachedSigner {
+public:
+  explicit CachedSigner(KeyChain& keyChain, const SigningInfo& si = SigningInfo())
+    : m_keyChain(keyChain)
+    , m_si(si) {}
+
+  template<typename Packet>
+  void sign(Packet& packet) {
+    resolve();
+    m_keyChain.sign(packet, m_si);
+  }
+
+  // Return the key name, or the unresolved signer name if the key cannot be found.
+  const Name& getSignerName() {
+    resolve();
+    return m_si.getSignerName();
+  }
+
+private:
+  void resolve() {
+    if (!m_isResolved) {
+      m_si = resolveSigningKey(m_keyChain, m_si);
+      m_isResolved = true;
+      StartupTimer::mark("signing-key");
+    }
+  }
+
+private:
+  KeyChain& m_keyChain;
+  SigningInfo m_si;
+  bool m_isResolved = false;
+};
+
 inline void
 enableLocalFields(nfd::Controller& controller, const std::function<void()>& then = nullptr) {
   controller.start<nfd::FaceUpdateCommand>(
     nfd::ControlParameters().setFlagBit(nfd::FaceFlagBit::BIT_LOCAL_FIELDS_ENABLED, true),
-    [&](const auto& cp) {
+    [then](const auto& cp) {
       std::cerr << "EnableLocalFields OK" << std::endl;
+      StartupTimer::mark("local-fields");
       if (then != nullptr) {
         then();
       }
@@ -95,12 +242,262 @@ enableLocalFields(nfd::Controller& controller, const std::function<void()>& then
     });
 }
 
+// A long-running service, hosted in its own program or in the ndn6-tools multiplexer.
+// Services hosted in the same process share one Face, KeyChain, and Scheduler.
+class Service : boost::noncopyable {
+public:
+  virtual ~Service() = default;
+
+  // Whether the service needs NDNLPv2 local fields, such as IncomingFaceId.
+  virtual bool needsLocalFields() const {
+    return false;
+  }
+
+  // Register prefixes and start timers. Local fields are enabled before this, if needed.
+  virtual void start() = 0;
+};
+
 inline void
 abortOnRegisterFail(const Name& name, const std::string& message) {
   std::cerr << "RegisterPrefix error " << name << " " << message << std::endl;
   std::exit(1);
 }
 
+// Process-wide counters, gauges, and latency histograms.
+// Counters and histograms are sharded per thread: the hot path is one relaxed atomic add on the
+// calling thread's shard, without locks. Gauges are single atomics. Metrics are registered by
+// name at startup; registering the same name again returns the same metric.
+class Metrics : boost::noncopyable {
+public:
+  static constexpr size_t MAX_SLOTS = 512;
+  static constexpr size_t MAX_SHARDS = 32;
+  // histogram bucket upper bounds in microseconds, the last bucket is unbounded
+  static constexpr std::array<uint64_t, 12> LATENCY_BOUNDS = {
+    10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, UINT64_MAX};
+
+  enum {
+    TtMetric = 0xC8,
+    TtMetricName = 0xC9,
+    TtMetricValue = 0xCA,
+    TtMetricBucket = 0xCB,
+    TtMetricBucketBound = 0xCC,
+    TtMetricSum = 0xCD,
+  };
+
+  class Counter {
+  public:
+    void inc(uint64_t n = 1) const {
+      Metrics::get().shard()[m_slot].fetch_add(n, std::memory_order_relaxed);
+    }
+
+  private:
+    explicit Counter(size_t slot)
+      : m_slot(slot) {}
+
+    size_t m_slot;
+    friend Metrics;
+  };
+
+  class Gauge {
+  public:
+    void set(int64_t value) const {
+      Metrics::get().m_gauges[m_slot].store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t delta) const {
+      Metrics::get().m_gauges[m_slot].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+  private:
+    explicit Gauge(size_t slot)
+      : m_slot(slot) {}
+
+    size_t m_slot;
+    friend Metrics;
+  };
+
+  class Histogram {
+  public:
+    void observe(time::nanoseconds duration) const {
+      uint64_t micros = std::max<int64_t>(0, duration.count() / 1000);
+      size_t bucket = 0;
+      while (micros > LATENCY_BOUNDS[bucket]) {
+        ++bucket;
+      }
+      auto& shard = Metrics::get().shard();
+      shard[m_slot + bucket].fetch_add(1, std::memory_order_relaxed);
+      shard[m_slot + LATENCY_BOUNDS.size()].fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    // Observe the time elapsed since start.
+    void observeSince(time::steady_clock::time_point start) const {
+      observe(time::steady_clock::now() - start);
+    }
+
+  private:
+    explicit Histogram(size_t slot)
+      : m_slot(slot) {}
+
+    size_t m_slot;
+    friend Metrics;
+  };
+
+  static Metrics& get() {
+    static Metrics instance;
+    return instance;
+  }
+
+  Counter counter(const std::string& name) {
+    return Counter(define(name, Kind::COUNTER, 1));
+  }
+
+  Gauge gauge(const std::string& name) {
+    return Gauge(define(name, Kind::GAUGE, 1));
+  }
+
+  Histogram histogram(const std::string& name) {
+    return Histogram(define(name, Kind::HISTOGRAM, LATENCY_BOUNDS.size() + 1));
+  }
+
+  // Encode current values, one Metric element per metric.
+  std::vector<Block> snapshot() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Block> blocks;
+    for (const auto& def : m_defs) {
+      Block metric(TtMetric);
+      metric.push_back(ndn::encoding::makeStringBlock(TtMetricName, def.name));
+      switch (def.kind) {
+        case Kind::COUNTER:
+          metric.push_back(
+            ndn::encoding::makeNonNegativeIntegerBlock(TtMetricValue, sum(def.slot)));
+          break;
+        case Kind::GAUGE:
+          // negative gauge is encoded in two's complement
+          metric.push_back(ndn::encoding::makeNonNegativeIntegerBlock(
+            TtMetricValue, static_cast<uint64_t>(m_gauges[def.slot].load())));
+          break;
+        case Kind::HISTOGRAM: {
+          uint64_t total = 0;
+          for (size_t i = 0; i < LATENCY_BOUNDS.size(); ++i) {
+            uint64_t count = sum(def.slot + i);
+            total += count;
+            Block bucket(TtMetricBucket);
+            if (LATENCY_BOUNDS[i] != UINT64_MAX) {
+              bucket.push_back(
+                ndn::encoding::makeNonNegativeIntegerBlock(TtMetricBucketBound, LATENCY_BOUNDS[i]));
+            }
+            bucket.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtMetricValue, count));
+            bucket.encode();
+            metric.push_back(bucket);
+          }
+          metric.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtMetricValue, total));
+          metric.push_back(ndn::encoding::makeNonNegativeIntegerBlock(
+            TtMetricSum, sum(def.slot + LATENCY_BOUNDS.size())));
+          break;
+        }
+      }
+      metric.encode();
+      blocks.push_back(std::move(metric));
+    }
+    return blocks;
+  }
+
+private:
+  enum class Kind {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM,
+  };
+
+  struct Def {
+    std::string name;
+    Kind kind;
+    size_t slot;
+  };
+
+  struct alignas(64) Shard : std::array<std::atomic<uint64_t>, MAX_SLOTS> {
+    Shard() {
+      for (auto& value : *this) {
+        value.store(0, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  Metrics() {
+    for (auto& gauge : m_gauges) {
+      gauge.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  size_t define(const std::string& name, Kind kind, size_t nSlots) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& def : m_defs) {
+      if (def.name == name) {
+        return def.slot;
+      }
+    }
+    size_t& next = kind == Kind::GAUGE ? m_nGaugeSlots : m_nSlots;
+    if (next + nSlots > MAX_SLOTS) {
+      throw std::length_error("too many metrics");
+    }
+    m_defs.push_back(Def{name, kind, next});
+    next += nSlots;
+    return m_defs.back().slot;
+  }
+
+  // Return the calling thread's shard. Threads beyond MAX_SHARDS share the last shard.
+  Shard& shard() {
+    thread_local Shard* shard = nullptr;
+    if (shard == nullptr) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_nShards < MAX_SHARDS) {
+        m_shards[m_nShards++] = std::make_unique<Shard>();
+      }
+      shard = m_shards[m_nShards - 1].get();
+    }
+    return *shard;
+  }
+
+  // Sum a slot over all shards. Caller must hold m_mutex.
+  uint64_t sum(size_t slot) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < m_nShards; ++i) {
+      total += (*m_shards[i])[slot].load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<Def> m_defs;
+  size_t m_nSlots = 0;
+  size_t m_nGaugeSlots = 0;
+  std::array<std::unique_ptr<Shard>, MAX_SHARDS> m_shards;
+  size_t m_nShards = 0;
+  std::array<std::atomic<int64_t>, MAX_SLOTS> m_gauges;
+};
+
+// Publish Metrics snapshot as a status dataset at <prefix>/metrics.
+// The dataset is a sequence of Metric elements; see Metrics::snapshot for encoding.
+class MetricsPublisher : boost::noncopyable {
+public:
+  explicit MetricsPublisher(Face& face, KeyChain& keyChain, const Name& prefix)
+    : m_dispatcher(face, keyChain) {
+    m_dispatcher.addStatusDataset(
+      "metrics", ndn::mgmt::makeAcceptAllAuthorization(),
+      [](const Name&, const Interest&, ndn::mgmt::StatusDatasetContext& context) {
+        for (const auto& block : Metrics::get().snapshot()) {
+          context.append(block);
+        }
+        context.end();
+      });
+    m_dispatcher.addTopPrefix(prefix);
+  }
+
+private:
+  ndn::mgmt::Dispatcher m_dispatcher;
+};
+
 } // namespace ndn6
 
 #endif // NDN6_TOOLS_COMMON_HPP
@@ -0,0 +1,164 @@
+#include "common.hpp"
+#include "facemon-record.hpp"
+
+#include <cinttypes>
+#include <set>
+
+namespace ndn6::facemon_read {
+
+using namespace ndn6::facemon;
+
+static std::set<uint64_t> faceFilter;
+static uint64_t since = 0;
+static uint64_t until = UINT64_MAX;
+static bool wantNanos = false;
+
+static uint64_t
+secondsToNanos(double seconds) {
+  return static_cast<uint64_t>(seconds * 1e9);
+}
+
+static void
+printTimestamp(uint64_t timestamp) {
+  if (wantNanos) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%" PRIu64 ".%09" PRIu64, timestamp / 1000000000,
+                  timestamp % 1000000000);
+    std::cout << buf;
+  } else {
+    std::cout << timestamp / 1000000000;
+  }
+}
+
+static void
+printRecord(const RecordHeader& hdr, ndn::span<const uint8_t> payload) {
+  switch (static_cast<RecordType>(hdr.type)) {
+    case RecordType::INTEREST: {
+      Name suffix(ndn::encoding::makeBinaryBlock(tlv::Name, payload));
+      printTimestamp(hdr.timestamp);
+      std::cout << '\t' << "INTEREST" << '\t' << hdr.faceId;
+      for (const auto& comp : suffix) {
+        std::cout << '\t' << comp;
+      }
+      std::cout << '\n';
+      return;
+    }
+    case RecordType::CREATED:
+    case RecordType::DESTROYED:
+    case RecordType::FACE_EVENT_OTHER:
+      break;
+    default:
+      return;
+  }
+
+  uint16_t lens[2];
+  if (payload.size() < sizeof(lens)) {
+    return;
+  }
+  std::memcpy(lens, payload.data(), sizeof(lens));
+  if (payload.size() < sizeof(lens) + lens[0] + lens[1]) {
+    return;
+  }
+  auto uris = reinterpret_cast<const char*>(payload.data()) + sizeof(lens);
+
+  printTimestamp(hdr.timestamp);
+  std::cout << '\t';
+  switch (static_cast<RecordType>(hdr.type)) {
+    case RecordType::CREATED:
+      std::cout << "CREATED";
+      break;
+    case RecordType::DESTROYED:
+      std::cout << "DESTROYED";
+      break;
+    default:
+      std::cout << "-";
+      break;
+  }
+  std::cout << '\t' << hdr.faceId << '\t' << std::string_view(uris, lens[0]) << '\t'
+            << std::string_view(uris + lens[0], lens[1]) << '\n';
+}
+
+static void
+readFile(const fs::path& path) {
+  RecordReader reader(path);
+  RecordHeader hdr;
+  ndn::span<const uint8_t> payload;
+  while (reader.next(hdr, payload)) {
+    if (hdr.timestamp < since || hdr.timestamp >= until ||
+        (!faceFilter.empty() && faceFilter.count(hdr.faceId) == 0)) {
+      continue;
+    }
+    try {
+      printRecord(hdr, payload);
+    } catch (const tlv::Error& e) {
+      std::cerr << path.string() << ": bad record " << e.what() << std::endl;
+    }
+  }
+}
+
+int
+main(int argc, char** argv) {
+  std::vector<std::string> inputs;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: ndn6-facemon-read [options] INPUT...\n"
+    "\n"
+    "Convert ndn6-facemon binary records to text.\n"
+    "INPUT may be a record file or a directory of record files.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("input", po::value(&inputs)->required()->composing(), "record files");
+      addOption("face", po::value<std::vector<uint64_t>>()->composing(), "only print this FaceId");
+      addOption("since", po::value<double>(), "only print records at or after this Unix time");
+      addOption("until", po::value<double>(), "only print records before this Unix time");
+      addOption("nanos", po::bool_switch(&wantNanos), "print timestamps in nanosecond precision");
+    },
+    "input");
+
+  if (args.count("face") > 0) {
+    for (auto faceId : args["face"].as<std::vector<uint64_t>>()) {
+      faceFilter.insert(faceId);
+    }
+  }
+  if (args.count("since") > 0) {
+    since = secondsToNanos(args["since"].as<double>());
+  }
+  if (args.count("until") > 0) {
+    until = secondsToNanos(args["until"].as<double>());
+  }
+
+  std::vector<fs::path> files;
+  for (const auto& input : inputs) {
+    if (!fs::is_directory(input)) {
+      files.emplace_back(input);
+      continue;
+    }
+    std::vector<fs::path> dirFiles;
+    for (const auto& entry : fs::directory_iterator(input)) {
+      if (RecordWriter::isRecordFile(entry.path())) {
+        dirFiles.push_back(entry.path());
+      }
+    }
+    std::sort(dirFiles.begin(), dirFiles.end());
+    files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+  }
+
+  int ret = 0;
+  for (const auto& file : files) {
+    try {
+      readFile(file);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      ret = 1;
+    }
+  }
+  std::cout.flush();
+  return ret;
+}
+
+} // namespace ndn6::facemon_read
+
+int
+main(int argc, char** argv) {
+  return ndn6::facemon_read::main(argc, argv);
+}
@@ -0,0 +1,241 @@
+#ifndef NDN6_TOOLS_FACEMON_RECORD_HPP
+#define NDN6_TOOLS_FACEMON_RECORD_HPP
+
+#include "common.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn6::facemon {
+
+namespace fs = boost::filesystem;
+
+// Binary recording of facemon events.
+//
+// A record file starts with an 8-octet magic string, followed by records. Each record starts
+// with RecordHeader in host byte order, followed by payload. The next record starts at the
+// next multiple of 8 octets. A record with zero size marks the end of the file.
+//
+// INTEREST payload: Interest name components after the facemon prefix, in TLV format.
+// Face event payload: uint16 RemoteUri length, uint16 LocalUri length, RemoteUri, LocalUri.
+
+enum class RecordType : uint16_t {
+  INTEREST = 1,
+  CREATED = 2,
+  DESTROYED = 3,
+  FACE_EVENT_OTHER = 4,
+};
+
+struct RecordHeader {
+  uint32_t size; // including header, excluding padding
+  uint16_t type;
+  uint16_t reserved;
+  uint64_t timestamp; // nanoseconds since Unix epoch
+  uint64_t faceId;
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+static const char RECORD_MAGIC[8] = {'N', 'D', 'N', '6', 'F', 'M', '0', '1'};
+
+static const auto nRecordsDropped = Metrics::get().counter("records-dropped");
+
+constexpr size_t
+alignRecord(size_t size) {
+  return (size + 7) & ~size_t(7);
+}
+
+inline uint64_t
+nowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+inline std::runtime_error
+makeSystemError(const std::string& what, const fs::path& path) {
+  return std::runtime_error(what + " " + path.string() + ": " + std::strerror(errno));
+}
+
+// Append records to mmapped files in a directory.
+// When a file is full, a new file is started; the oldest files are deleted to keep at most
+// maxFiles files. File names are "facemon-<timestamp>.rec" so that they sort chronologically.
+class RecordWriter : boost::noncopyable {
+public:
+  explicit RecordWriter(const fs::path& dir, size_t fileSize, size_t maxFiles)
+    : m_dir(dir)
+    , m_fileSize(std::max<size_t>(fileSize, 65536) & ~size_t(7))
+    , m_maxFiles(std::max<size_t>(maxFiles, 1)) {
+    fs::create_directories(m_dir);
+    std::vector<fs::path> existing;
+    for (const auto& entry : fs::directory_iterator(m_dir)) {
+      if (isRecordFile(entry.path())) {
+        existing.push_back(entry.path());
+      }
+    }
+    std::sort(existing.begin(), existing.end());
+    m_files.assign(existing.begin(), existing.end());
+  }
+
+  ~RecordWriter() {
+    closeFile();
+  }
+
+  static bool isRecordFile(const fs::path& path) {
+    auto filename = path.filename().string();
+    return filename.size() > 12 && filename.compare(0, 8, "facemon-") == 0 &&
+           path.extension() == ".rec";
+  }
+
+  // Append a record. writePayload(uint8_t* dst) must write exactly payloadSize octets.
+  // A record that does not fit in an empty file is dropped, and counted in records-dropped.
+  template<typename F>
+  void append(RecordType type, uint64_t faceId, size_t payloadSize, const F& writePayload) {
+    size_t size = sizeof(RecordHeader) + payloadSize;
+    size_t stride = alignRecord(size);
+    // leave room for an end-of-file header
+    if (sizeof(RECORD_MAGIC) + stride + sizeof(RecordHeader) > m_fileSize) {
+      nRecordsDropped.inc();
+      std::cerr << "record dropped: size " << size << " exceeds file size " << m_fileSize
+                << std::endl;
+      return;
+    }
+    if (m_base == nullptr || m_offset + stride + sizeof(RecordHeader) > m_fileSize) {
+      openFile();
+    }
+
+    uint8_t* room = m_base + m_offset;
+    RecordHeader hdr{static_cast<uint32_t>(size), static_cast<uint16_t>(type), 0, nowNanos(),
+                     faceId};
+    writePayload(room + sizeof(hdr));
+    std::memcpy(room, &hdr, sizeof(hdr));
+    m_offset += stride;
+  }
+
+private:
+  void openFile() {
+    closeFile();
+
+    fs::path path = m_dir / ("facemon-" + std::to_string(nowNanos()) + ".rec");
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      throw makeSystemError("open", path);
+    }
+    if (::ftruncate(fd, m_fileSize) != 0) {
+      ::close(fd);
+      throw makeSystemError("ftruncate", path);
+    }
+    void* base = ::mmap(nullptr, m_fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      ::close(fd);
+      throw makeSystemError("mmap", path);
+    }
+
+    m_fd = fd;
+    m_base = static_cast<uint8_t*>(base);
+    std::memcpy(m_base, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    m_offset = sizeof(RECORD_MAGIC);
+
+    m_files.push_back(path);
+    while (m_files.size() > m_maxFiles) {
+      boost::system::error_code ec;
+      fs::remove(m_files.front(), ec);
+      m_files.pop_front();
+    }
+  }
+
+  // Unmap current file, and truncate it to used size.
+  void closeFile() {
+    if (m_base == nullptr) {
+      return;
+    }
+    ::munmap(m_base, m_fileSize);
+    m_base = nullptr;
+    if (::ftruncate(m_fd, m_offset) != 0) {
+      std::cerr << "ftruncate " << m_files.back() << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(m_fd);
+    m_fd = -1;
+  }
+
+private:
+  fs::path m_dir;
+  size_t m_fileSize;
+  size_t m_maxFiles;
+  std::deque<fs::path> m_files;
+  int m_fd = -1;
+  uint8_t* m_base = nullptr;
+  size_t m_offset = 0;
+};
+
+// Iterate over records in a record file.
+class RecordReader : boost::noncopyable {
+public:
+  explicit RecordReader(const fs::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw makeSystemError("open", path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw makeSystemError("fstat", path);
+    }
+    m_size = st.st_size;
+    if (m_size > 0) {
+      void* base = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (base == MAP_FAILED) {
+        throw makeSystemError("mmap", path);
+      }
+      m_base = static_cast<const uint8_t*>(base);
+    } else {
+      ::close(fd);
+    }
+
+    if (m_size < sizeof(RECORD_MAGIC) ||
+        std::memcmp(m_base, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0) {
+      if (m_base != nullptr) {
+        ::munmap(const_cast<uint8_t*>(m_base), m_size);
+      }
+      throw std::runtime_error("not a facemon record file: " + path.string());
+    }
+    m_offset = sizeof(RECORD_MAGIC);
+  }
+
+  ~RecordReader() {
+    if (m_base != nullptr) {
+      ::munmap(const_cast<uint8_t*>(m_base), m_size);
+      m_base = nullptr;
+    }
+  }
+
+  // Read next record. Returns false at end of file.
+  bool next(RecordHeader& hdr, ndn::span<const uint8_t>& payload) {
+    if (m_offset + sizeof(hdr) > m_size) {
+      return false;
+    }
+    std::memcpy(&hdr, m_base + m_offset, sizeof(hdr));
+    if (hdr.size < sizeof(hdr) || m_offset + hdr.size > m_size) {
+      return false;
+    }
+    payload = ndn::span<const uint8_t>(m_base + m_offset + sizeof(hdr), hdr.size - sizeof(hdr));
+    m_offset += alignRecord(hdr.size);
+    return true;
+  }
+
+private:
+  const uint8_t* m_base = nullptr;
+  size_t m_size = 0;
+  size_t m_offset = 0;
+};
+
+} // namespace ndn6::facemon
+
+#endif // NDN6_TOOLS_FACEMON_RECORD_HPP
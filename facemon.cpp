@@ -1,54 +1,34 @@
 #include "common.hpp"
-
-#include <ndn-cxx/mgmt/nfd/face-monitor.hpp>
+#include "facemon.hpp"
 
 namespace ndn6::facemon {
 
-void
-printInterest(const Name& prefix, const Interest& interest) {
-  auto incomingFace = interest.getTag<lp::IncomingFaceIdTag>();
-  if (incomingFace == nullptr) {
-    return;
+int
+main(int argc, char** argv) {
+  auto opts =
+    exitOnUsageError([&] { return parseOptions(std::vector<std::string>(argv + 1, argv + argc)); });
+
+  KeyChain& keyChain = getKeyChain();
+  Face face(nullptr, keyChain);
+  Scheduler sched(face.getIoContext());
+  std::unique_ptr<Facemon> app;
+  try {
+    app = std::make_unique<Facemon>(face, keyChain, sched, opts);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
   }
 
-  std::cout << ::time(0) << '\t' << "INTEREST" << '\t' << *incomingFace;
-  for (size_t i = prefix.size(); i < interest.getName().size(); ++i) {
-    std::cout << '\t' << interest.getName().get(i);
+  std::optional<MetricsPublisher> metricsPublisher;
+  if (!opts.metricsPrefix.empty()) {
+    metricsPublisher.emplace(face, keyChain, opts.metricsPrefix);
   }
-  std::cout << std::endl;
-}
-
-void
-printNotification(const nfd::FaceEventNotification& n) {
-  std::cout << ::time(0) << '\t';
-  switch (n.getKind()) {
-    case nfd::FACE_EVENT_CREATED:
-      std::cout << "CREATED";
-      break;
-    case nfd::FACE_EVENT_DESTROYED:
-      std::cout << "DESTROYED";
-      break;
-    default:
-      std::cout << "-";
-      break;
-  }
-  std::cout << '\t' << n.getFaceId() << '\t' << n.getRemoteUri() << '\t' << n.getLocalUri()
-            << std::endl;
-}
-
-int
-main() {
-  Face face;
-  KeyChain keyChain;
 
   nfd::Controller controller(face, keyChain);
-  enableLocalFields(controller);
-  face.setInterestFilter("/localhop/facemon", printInterest, abortOnRegisterFail);
-
-  nfd::FaceMonitor fm(face);
-  fm.onNotification.connect(&printNotification);
-  fm.start();
-
+  enableLocalFields(controller, [&] {
+    app->start();
+    StartupTimer::mark("started");
+  });
   face.processEvents();
   return 0;
 }
@@ -57,5 +37,5 @@ main() {
 
 int
 main(int argc, char** argv) {
-  return ndn6::facemon::main();
+  return ndn6::facemon::main(argc, argv);
 }
@@ -0,0 +1,588 @@
+#ifndef NDN6_TOOLS_FACEMON_HPP
+#define NDN6_TOOLS_FACEMON_HPP
+
+#include "common.hpp"
+#include "facemon-record.hpp"
+#include "hyperloglog.hpp"
+
+#include <ndn-cxx/mgmt/nfd/face-monitor.hpp>
+
+#include <boost/asio/signal_set.hpp>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+namespace ndn6::facemon {
+
+inline void
+printInterest(const Name& prefix, const Interest& interest) {
+  auto incomingFace = interest.getTag<lp::IncomingFaceIdTag>();
+  if (incomingFace == nullptr) {
+    return;
+  }
+
+  std::cout << ::time(0) << '\t' << "INTEREST" << '\t' << *incomingFace;
+  for (size_t i = prefix.size(); i < interest.getName().size(); ++i) {
+    std::cout << '\t' << interest.getName().get(i);
+  }
+  std::cout << std::endl;
+}
+
+inline void
+recordInterest(RecordWriter& recorder, const Name& prefix, const Interest& interest) {
+  auto incomingFace = interest.getTag<lp::IncomingFaceIdTag>();
+  if (incomingFace == nullptr) {
+    return;
+  }
+
+  const Name& name = interest.getName();
+  size_t payloadSize = 0;
+  for (size_t i = prefix.size(); i < name.size(); ++i) {
+    payloadSize += name[i].size();
+  }
+  recorder.append(RecordType::INTEREST, *incomingFace, payloadSize, [&](uint8_t* dst) {
+    for (size_t i = prefix.size(); i < name.size(); ++i) {
+      dst = std::copy(name[i].begin(), name[i].end(), dst);
+    }
+  });
+}
+
+inline void
+printNotification(const nfd::FaceEventNotification& n) {
+  std::cout << ::time(0) << '\t';
+  switch (n.getKind()) {
+    case nfd::FACE_EVENT_CREATED:
+      std::cout << "CREATED";
+      break;
+    case nfd::FACE_EVENT_DESTROYED:
+      std::cout << "DESTROYED";
+      break;
+    default:
+      std::cout << "-";
+      break;
+  }
+  std::cout << '\t' << n.getFaceId() << '\t' << n.getRemoteUri() << '\t' << n.getLocalUri()
+            << std::endl;
+}
+
+inline void
+recordNotification(RecordWriter& recorder, const nfd::FaceEventNotification& n) {
+  RecordType type = RecordType::FACE_EVENT_OTHER;
+  switch (n.getKind()) {
+    case nfd::FACE_EVENT_CREATED:
+      type = RecordType::CREATED;
+      break;
+    case nfd::FACE_EVENT_DESTROYED:
+      type = RecordType::DESTROYED;
+      break;
+    default:
+      break;
+  }
+
+  const std::string& remote = n.getRemoteUri();
+  const std::string& local = n.getLocalUri();
+  uint16_t lens[2] = {
+    static_cast<uint16_t>(std::min<size_t>(remote.size(), 0xFFFF)),
+    static_cast<uint16_t>(std::min<size_t>(local.size(), 0xFFFF)),
+  };
+  recorder.append(type, n.getFaceId(), sizeof(lens) + lens[0] + lens[1], [&](uint8_t* dst) {
+    std::memcpy(dst, lens, sizeof(lens));
+    dst += sizeof(lens);
+    dst = std::copy_n(remote.begin(), lens[0], dst);
+    std::copy_n(local.begin(), lens[1], dst);
+  });
+}
+
+// Periodically fetch face counters, compute per-face rates, and print top faces by packet rate.
+// Each face keeps a fixed-size ring of recent rates. Faces absent from the latest dataset are
+// dropped, and at most maxFaces faces are tracked.
+class FaceSampler : boost::noncopyable {
+public:
+  struct Options {
+    time::milliseconds interval = 0_ms;
+    size_t window = 60;
+    size_t topK = 10;
+    size_t maxFaces = 4096;
+  };
+
+  explicit FaceSampler(nfd::Controller& controller, Scheduler& sched, const Options& opts)
+    : m_controller(controller)
+    , m_sched(sched)
+    , m_opts(opts) {
+    m_opts.window = std::max<size_t>(m_opts.window, 1);
+  }
+
+  void start() {
+    fetch();
+  }
+
+  void removeFace(uint64_t faceId) {
+    m_faces.erase(faceId);
+  }
+
+private:
+  struct Rate {
+    float inPps = 0;
+    float outPps = 0;
+    float inBps = 0;
+    float outBps = 0;
+  };
+
+  struct FaceRecord {
+    uint64_t generation = 0;
+    uint64_t counters[4] = {}; // in packets, out packets, in bytes, out bytes
+    std::vector<Rate> ring;
+    size_t nSamples = 0;
+    double meanPps = 0;
+    double peakPps = 0;
+  };
+
+  void fetch() {
+    m_controller.fetch<nfd::FaceDataset>(
+      [this](const std::vector<nfd::FaceStatus>& dataset) {
+        onDataset(dataset);
+        m_timer = m_sched.schedule(m_opts.interval, [this] { fetch(); });
+      },
+      [this](uint32_t code, const std::string& reason) {
+        std::cerr << "FaceDataset error " << code << " " << reason << std::endl;
+        m_timer = m_sched.schedule(m_opts.interval, [this] { fetch(); });
+      });
+  }
+
+  void onDataset(const std::vector<nfd::FaceStatus>& dataset) {
+    auto now = time::steady_clock::now();
+    double seconds = time::duration_cast<time::microseconds>(now - m_lastSample).count() / 1e6;
+    bool hasInterval = m_generation > 0 && seconds > 0;
+    m_lastSample = now;
+    ++m_generation;
+
+    Rate total;
+    for (const auto& status : dataset) {
+      auto it = m_faces.find(status.getFaceId());
+      bool isNew = it == m_faces.end();
+      if (isNew) {
+        if (m_faces.size() >= m_opts.maxFaces) {
+          continue;
+        }
+        it = m_faces.emplace(status.getFaceId(), FaceRecord()).first;
+        it->second.ring.resize(m_opts.window);
+      }
+
+      FaceRecord& record = it->second;
+      uint64_t counters[4] = {
+        status.getNInInterests() + status.getNInData() + status.getNInNacks(),
+        status.getNOutInterests() + status.getNOutData() + status.getNOutNacks(),
+        status.getNInBytes(),
+        status.getNOutBytes(),
+      };
+      if (!isNew && hasInterval) {
+        // a counter that went backwards yields zero rate
+        float delta[4];
+        for (size_t i = 0; i < 4; ++i) {
+          uint64_t diff = counters[i] >= record.counters[i] ? counters[i] - record.counters[i] : 0;
+          delta[i] = static_cast<float>(diff / seconds);
+        }
+        Rate rate{delta[0], delta[1], delta[2], delta[3]};
+        addSample(record, rate);
+        total.inPps += rate.inPps;
+        total.outPps += rate.outPps;
+        total.inBps += rate.inBps;
+        total.outBps += rate.outBps;
+      }
+      std::copy_n(counters, 4, record.counters);
+      record.generation = m_generation;
+    }
+
+    for (auto it = m_faces.begin(); it != m_faces.end();) {
+      if (it->second.generation == m_generation) {
+        ++it;
+      } else {
+        it = m_faces.erase(it);
+      }
+    }
+
+    if (hasInterval) {
+      print(total);
+    }
+  }
+
+  void addSample(FaceRecord& record, const Rate& rate) {
+    record.ring[record.nSamples % record.ring.size()] = rate;
+    ++record.nSamples;
+
+    size_t n = std::min(record.nSamples, record.ring.size());
+    double sum = 0;
+    record.peakPps = 0;
+    for (size_t i = 0; i < n; ++i) {
+      double pps = record.ring[i].inPps + record.ring[i].outPps;
+      sum += pps;
+      record.peakPps = std::max(record.peakPps, pps);
+    }
+    record.meanPps = sum / n;
+  }
+
+  void print(const Rate& total) {
+    auto timestamp = ::time(0);
+    std::cout << timestamp << '\t' << "SAMPLE" << '\t' << m_faces.size() << '\t'
+              << std::llround(total.inPps) << '\t' << std::llround(total.outPps) << '\t'
+              << std::llround(total.inBps) << '\t' << std::llround(total.outBps) << '\n';
+
+    m_top.clear();
+    for (const auto& [faceId, record] : m_faces) {
+      if (record.nSamples > 0) {
+        m_top.emplace_back(faceId, &record);
+      }
+    }
+    size_t k = std::min(m_opts.topK, m_top.size());
+    std::partial_sort(m_top.begin(), m_top.begin() + k, m_top.end(),
+                      [](const auto& a, const auto& b) {
+                        return a.second->meanPps > b.second->meanPps;
+                      });
+
+    for (size_t i = 0; i < k; ++i) {
+      const auto& [faceId, record] = m_top[i];
+      const Rate& rate = record->ring[(record->nSamples - 1) % record->ring.size()];
+      std::cout << timestamp << '\t' << "TOP" << '\t' << faceId << '\t'
+                << std::llround(rate.inPps) << '\t' << std::llround(rate.outPps) << '\t'
+                << std::llround(rate.inBps) << '\t' << std::llround(rate.outBps) << '\t'
+                << std::llround(record->meanPps) << '\t' << std::llround(record->peakPps) << '\n';
+    }
+    std::cout.flush();
+  }
+
+private:
+  nfd::Controller& m_controller;
+  Scheduler& m_sched;
+  Options m_opts;
+  ndn::scheduler::ScopedEventId m_timer;
+  uint64_t m_generation = 0;
+  time::steady_clock::time_point m_lastSample;
+  std::unordered_map<uint64_t, FaceRecord> m_faces;
+  std::vector<std::pair<uint64_t, const FaceRecord*>> m_top;
+};
+
+// Count probe Interests per (face, suffix) within a window, and print summaries at the end of
+// each window. The table has a fixed number of entries, and suffixes are copied into a
+// fixed-size arena; probes that do not fit are only counted in per-face totals. Distinct
+// suffixes per face are estimated with HyperLogLog, and at most maxFaces faces have per-face
+// totals, so that memory stays bounded.
+class ProbeAggregator : boost::noncopyable {
+public:
+  struct Options {
+    time::milliseconds interval = 0_ms;
+    size_t capacity = 65536;
+    size_t topN = 20;
+    size_t maxFaces = 4096;
+  };
+
+  static constexpr size_t ARENA_PER_ENTRY = 64;
+  // Arena offsets are uint32.
+  static constexpr size_t MAX_CAPACITY = std::numeric_limits<uint32_t>::max() / ARENA_PER_ENTRY;
+
+  explicit ProbeAggregator(Scheduler& sched, const Options& opts)
+    : m_sched(sched)
+    , m_opts(opts) {
+    size_t nSlots = 2;
+    while (nSlots < 2 * m_opts.capacity) {
+      nSlots <<= 1;
+    }
+    m_slots.resize(nSlots);
+    m_mask = nSlots - 1;
+    m_arena.resize(m_opts.capacity * ARENA_PER_ENTRY);
+  }
+
+  void start() {
+    m_timer = m_sched.schedule(m_opts.interval, [this] { endWindow(); });
+  }
+
+  void add(const Name& prefix, const Interest& interest) {
+    auto incomingFace = interest.getTag<lp::IncomingFaceIdTag>();
+    if (incomingFace == nullptr) {
+      return;
+    }
+    uint64_t faceId = *incomingFace;
+    const Name& name = interest.getName();
+
+    uint64_t hash = 0;
+    size_t length = 0;
+    for (size_t i = prefix.size(); i < name.size(); ++i) {
+      std::string_view wire(reinterpret_cast<const char*>(name[i].data()), name[i].size());
+      hash = mix(hash ^ std::hash<std::string_view>()(wire));
+      length += name[i].size();
+    }
+
+    auto it = m_faces.find(faceId);
+    if (it == m_faces.end() && m_faces.size() < m_opts.maxFaces) {
+      it = m_faces.emplace(faceId, FaceProbes()).first;
+    }
+    if (it == m_faces.end()) {
+      ++m_nUntrackedFaces;
+    } else {
+      ++it->second.count;
+      it->second.distinct.add(hash);
+    }
+
+    Slot* slot = find(faceId, hash);
+    if (slot->count > 0) {
+      ++slot->count;
+      return;
+    }
+    if (m_nEntries >= m_opts.capacity || m_arenaUsed + length > m_arena.size()) {
+      ++m_nUntracked;
+      return;
+    }
+
+    ++m_nEntries;
+    *slot = Slot{faceId, hash, 1, static_cast<uint32_t>(m_arenaUsed),
+                 static_cast<uint32_t>(length)};
+    for (size_t i = prefix.size(); i < name.size(); ++i) {
+      std::copy(name[i].begin(), name[i].end(), m_arena.data() + m_arenaUsed);
+      m_arenaUsed += name[i].size();
+    }
+  }
+
+private:
+  struct Slot {
+    uint64_t faceId = 0;
+    uint64_t hash = 0;
+    uint32_t count = 0; // 0 means empty
+    uint32_t arenaOffset = 0;
+    uint32_t arenaLength = 0;
+  };
+
+  struct FaceProbes {
+    uint64_t count = 0;
+    HyperLogLog distinct;
+  };
+
+  // Final mixing step of SplitMix64.
+  static uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+  }
+
+  // Find slot of (faceId, hash), or the empty slot where it should be inserted.
+  // This always terminates because the table is at most half full.
+  Slot* find(uint64_t faceId, uint64_t hash) {
+    for (size_t i = mix(hash ^ faceId);; ++i) {
+      Slot& slot = m_slots[i & m_mask];
+      if (slot.count == 0 || (slot.faceId == faceId && slot.hash == hash)) {
+        return &slot;
+      }
+    }
+  }
+
+  void endWindow() {
+    auto timestamp = ::time(0);
+
+    std::vector<std::pair<uint64_t, const FaceProbes*>> faces;
+    for (const auto& [faceId, faceProbes] : m_faces) {
+      faces.emplace_back(faceId, &faceProbes);
+    }
+    std::sort(faces.begin(), faces.end(),
+              [](const auto& a, const auto& b) { return a.second->count > b.second->count; });
+    for (const auto& [faceId, faceProbes] : faces) {
+      std::cout << timestamp << '\t' << "PROBES" << '\t' << faceId << '\t' << faceProbes->count
+                << '\t' << std::llround(faceProbes->distinct.estimate()) << '\n';
+    }
+
+    std::vector<const Slot*> top;
+    for (const auto& slot : m_slots) {
+      if (slot.count > 0) {
+        top.push_back(&slot);
+      }
+    }
+    size_t n = std::min(m_opts.topN, top.size());
+    std::partial_sort(top.begin(), top.begin() + n, top.end(),
+                      [](const Slot* a, const Slot* b) { return a->count > b->count; });
+    for (size_t i = 0; i < n; ++i) {
+      std::cout << timestamp << '\t' << "PROBE" << '\t' << top[i]->faceId << '\t'
+                << top[i]->count;
+      ndn::span<const uint8_t> wire(m_arena.data() + top[i]->arenaOffset, top[i]->arenaLength);
+      Name suffix(ndn::encoding::makeBinaryBlock(tlv::Name, wire));
+      for (const auto& comp : suffix) {
+        std::cout << '\t' << comp;
+      }
+      std::cout << '\n';
+    }
+
+    if (m_nUntracked > 0) {
+      std::cout << timestamp << '\t' << "PROBE-UNTRACKED" << '\t' << m_nUntracked << '\n';
+    }
+    if (m_nUntrackedFaces > 0) {
+      std::cout << timestamp << '\t' << "PROBE-UNTRACKED-FACES" << '\t' << m_nUntrackedFaces
+                << '\n';
+    }
+    std::cout.flush();
+
+    std::fill(m_slots.begin(), m_slots.end(), Slot{});
+    m_nEntries = 0;
+    m_arenaUsed = 0;
+    m_nUntracked = 0;
+    m_nUntrackedFaces = 0;
+    m_faces.clear();
+    start();
+  }
+
+private:
+  Scheduler& m_sched;
+  Options m_opts;
+  ndn::scheduler::ScopedEventId m_timer;
+  std::vector<Slot> m_slots;
+  size_t m_mask = 0;
+  size_t m_nEntries = 0;
+  std::vector<uint8_t> m_arena;
+  size_t m_arenaUsed = 0;
+  uint64_t m_nUntracked = 0;
+  uint64_t m_nUntrackedFaces = 0;
+  std::unordered_map<uint64_t, FaceProbes> m_faces;
+};
+
+struct Options {
+  std::string recordDir;
+  size_t recordSize = 64;
+  size_t recordFiles = 16;
+  FaceSampler::Options sample;
+  ProbeAggregator::Options aggregate;
+  Name metricsPrefix;
+};
+
+inline Options
+parseOptions(const std::vector<std::string>& args) {
+  Options opts;
+  int sampleInterval = 0;
+  int aggregateInterval = 0;
+  parseProgramOptions(
+    args,
+    "Usage: ndn6-facemon\n"
+    "\n"
+    "Log face events and Interests under /localhop/facemon.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("record", po::value(&opts.recordDir),
+                "write binary records to this directory instead of text to stdout");
+      addOption("record-size", po::value(&opts.recordSize)->default_value(opts.recordSize),
+                "size of each record file (MiB)");
+      addOption("record-files", po::value(&opts.recordFiles)->default_value(opts.recordFiles),
+                "maximum number of record files to keep");
+      addOption("sample", po::value(&sampleInterval),
+                "fetch face counters at this interval (seconds), 0 disables");
+      addOption("sample-window", po::value(&opts.sample.window)->default_value(opts.sample.window),
+                "number of samples kept per face");
+      addOption("top", po::value(&opts.sample.topK)->default_value(opts.sample.topK),
+                "number of top faces printed per sample");
+      addOption("sample-max-faces",
+                po::value(&opts.sample.maxFaces)->default_value(opts.sample.maxFaces),
+                "maximum number of faces tracked by sampler");
+      addOption("aggregate", po::value(&aggregateInterval),
+                "summarize probe Interests at this interval (seconds), 0 disables");
+      addOption("aggregate-capacity",
+                po::value(&opts.aggregate.capacity)
+                  ->default_value(opts.aggregate.capacity)
+                  ->notifier([](size_t v) {
+                    if (!(v >= 1 && v <= ProbeAggregator::MAX_CAPACITY)) {
+                      throw std::range_error("aggregate-capacity must be between 1 and " +
+                                             std::to_string(ProbeAggregator::MAX_CAPACITY));
+                    }
+                  }),
+                "maximum distinct (face, suffix) entries per window");
+      addOption("aggregate-max-faces",
+                po::value(&opts.aggregate.maxFaces)->default_value(opts.aggregate.maxFaces),
+                "maximum number of faces with per-face probe totals per window");
+      addOption("aggregate-top",
+                po::value(&opts.aggregate.topN)->default_value(opts.aggregate.topN),
+                "number of (face, suffix) entries printed per window");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    });
+  opts.sample.interval = time::seconds(sampleInterval);
+  opts.aggregate.interval = time::seconds(aggregateInterval);
+  return opts;
+}
+
+class Facemon : public Service {
+public:
+  // Throws if the record directory cannot be opened.
+  explicit Facemon(Face& face, KeyChain& keyChain, Scheduler& sched, const Options& opts)
+    : m_face(face)
+    , m_sched(sched)
+    , m_controller(face, keyChain)
+    , m_faceMonitor(face)
+    , m_opts(opts) {
+    if (!m_opts.recordDir.empty()) {
+      m_recorder = std::make_unique<RecordWriter>(m_opts.recordDir,
+                                                  m_opts.recordSize * 1024 * 1024,
+                                                  m_opts.recordFiles);
+    }
+  }
+
+  bool needsLocalFields() const override {
+    return true;
+  }
+
+  void start() override {
+    if (m_opts.aggregate.interval > 0_ms) {
+      m_aggregator.emplace(m_sched, m_opts.aggregate);
+      m_aggregator->start();
+    }
+    m_face.setInterestFilter(
+      "/localhop/facemon",
+      [this](const InterestFilter& filter, const Interest& interest) {
+        m_nProbes.inc();
+        if (m_aggregator) {
+          m_aggregator->add(filter, interest);
+        } else if (m_recorder != nullptr) {
+          recordInterest(*m_recorder, filter, interest);
+        } else {
+          printInterest(filter, interest);
+        }
+      },
+      abortOnRegisterFail);
+
+    if (m_opts.sample.interval > 0_ms) {
+      m_sampler.emplace(m_controller, m_sched, m_opts.sample);
+      m_sampler->start();
+    }
+
+    m_faceMonitor.onNotification.connect([this](const nfd::FaceEventNotification& n) {
+      m_nFaceEvents.inc();
+      if (m_recorder != nullptr) {
+        recordNotification(*m_recorder, n);
+      } else {
+        printNotification(n);
+      }
+      if (m_sampler && n.getKind() == nfd::FACE_EVENT_DESTROYED) {
+        m_sampler->removeFace(n.getFaceId());
+      }
+    });
+    m_faceMonitor.start();
+
+    // truncate record file to used size on normal termination
+    if (m_recorder != nullptr) {
+      m_stopSignal.emplace(m_face.getIoContext(), SIGINT, SIGTERM);
+      m_stopSignal->async_wait([this](const boost::system::error_code& ec, int) {
+        if (!ec) {
+          m_face.getIoContext().stop();
+        }
+      });
+    }
+  }
+
+private:
+  Face& m_face;
+  Scheduler& m_sched;
+  nfd::Controller m_controller;
+  nfd::FaceMonitor m_faceMonitor;
+  Options m_opts;
+  std::unique_ptr<RecordWriter> m_recorder;
+  std::optional<FaceSampler> m_sampler;
+  std::optional<ProbeAggregator> m_aggregator;
+  std::optional<boost::asio::signal_set> m_stopSignal;
+  Metrics::Counter m_nProbes = Metrics::get().counter("probes");
+  Metrics::Counter m_nFaceEvents = Metrics::get().counter("face-events");
+};
+
+} // namespace ndn6::facemon
+
+#endif // NDN6_TOOLS_FACEMON_HPP
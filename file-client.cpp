@@ -0,0 +1,536 @@
+#include "common.hpp"
+#include "file-server.hpp"
+
+#include <cstring>
+#include <deque>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn6::file_client {
+
+namespace fs = boost::filesystem;
+using file_server::metadataComponent;
+using file_server::SegmentLimit;
+
+struct Options {
+  Name remote;
+  fs::path local;
+  bool recursive = false;
+  size_t maxWindow = 256;
+  size_t parallel = 8;
+  time::milliseconds lifetime = 4_s;
+  int retries = 15;
+};
+
+// RDR metadata fields written by file_server::FileInfo::buildMetadata.
+struct Metadata {
+  Name versioned;
+  std::optional<uint64_t> lastSeg;
+  uint64_t segmentSize = 0;
+  uint64_t size = 0;
+  uint64_t mode = 0;
+  uint64_t mtime = 0;
+
+  bool isFile() const {
+    return S_ISREG(mode);
+  }
+
+  bool isDir() const {
+    return S_ISDIR(mode);
+  }
+
+  // Parse metadata content. Unrecognized TLV elements are ignored, as per protocol.
+  // Returns an error message, or empty string on success.
+  std::string decode(const Block& content) {
+    bool hasMode = false;
+    bool hasSegmentSize = false;
+    bool hasSize = false;
+    content.parse();
+    for (const Block& element : content.elements()) {
+      switch (element.type()) {
+        case tlv::Name:
+          versioned.wireDecode(element);
+          break;
+        case tlv::FinalBlockId:
+          element.parse();
+          lastSeg = name::Component(element.elements().at(0)).toSegment();
+          break;
+        case file_server::TtSegmentSize:
+          segmentSize = ndn::encoding::readNonNegativeInteger(element);
+          hasSegmentSize = true;
+          break;
+        case file_server::TtSize:
+          size = ndn::encoding::readNonNegativeInteger(element);
+          hasSize = true;
+          break;
+        case file_server::TtMode:
+          mode = ndn::encoding::readNonNegativeInteger(element);
+          hasMode = true;
+          break;
+        case file_server::TtMtime:
+          mtime = ndn::encoding::readNonNegativeInteger(element);
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (versioned.empty() || !versioned[-1].isVersion() || !hasMode) {
+      return "bad-metadata";
+    }
+    if (isFile() && (!lastSeg || !hasSegmentSize || segmentSize == 0 || !hasSize ||
+                     *lastSeg != SegmentLimit::computeLastSeg(size, segmentSize))) {
+      return "bad-metadata";
+    }
+    if (!isFile() && !isDir()) {
+      return "unsupported-mode";
+    }
+    return "";
+  }
+};
+
+// AIMD congestion window shared by all transfers.
+// The window grows exponentially until the first congestion signal, then by one per window of
+// Data, and halves upon CongestionMark, Nack, or timeout. It decreases at most once per round
+// trip: a signal on an Interest sent before the last decrease is ignored, because the window
+// has already reacted to that round.
+class CongestionWindow {
+public:
+  explicit CongestionWindow(size_t maxWindow)
+    : m_max(std::max<size_t>(maxWindow, 1))
+    , m_ssthresh(static_cast<double>(m_max)) {}
+
+  size_t size() const {
+    return static_cast<size_t>(m_cwnd);
+  }
+
+  void onData() {
+    m_cwnd += m_cwnd < m_ssthresh ? 1.0 : 1.0 / m_cwnd;
+    m_cwnd = std::min(m_cwnd, static_cast<double>(m_max));
+  }
+
+  void onCongestion(time::steady_clock::time_point sendTime) {
+    if (sendTime <= m_lastDecrease) {
+      return;
+    }
+    m_cwnd = m_ssthresh = std::max(m_cwnd / 2.0, 1.0);
+    m_lastDecrease = time::steady_clock::now();
+    ++nDecreases;
+  }
+
+public:
+  uint64_t nDecreases = 0;
+
+private:
+  size_t m_max;
+  double m_cwnd = 2.0;
+  double m_ssthresh;
+  time::steady_clock::time_point m_lastDecrease;
+};
+
+// A file or directory to be retrieved.
+struct Job {
+  Name remote;
+  fs::path local;
+};
+
+// Retrieval of one segmented object: a file written with pwrite, or a directory listing
+// collected in memory. Segments arrive in any order.
+struct Transfer {
+  Job job;
+  Metadata md;
+  int fd = -1;
+  std::map<uint64_t, std::string> listing;
+
+  bool isActive = true;
+  uint64_t nextSeg = 0;
+  std::deque<uint64_t> retxQueue;
+  std::map<uint64_t, int> nRetries;
+  uint64_t nReceived = 0;
+
+  bool hasNext() const {
+    if (!retxQueue.empty()) {
+      return true;
+    }
+    // directory listing learns last segment number from the first segment
+    return md.lastSeg ? nextSeg <= *md.lastSeg : nextSeg == 0;
+  }
+
+  uint64_t takeNext() {
+    if (!retxQueue.empty()) {
+      uint64_t seg = retxQueue.front();
+      retxQueue.pop_front();
+      return seg;
+    }
+    return nextSeg++;
+  }
+};
+
+class Client : boost::noncopyable {
+public:
+  explicit Client(Face& face, const Options& opts)
+    : m_face(face)
+    , m_sched(face.getIoContext())
+    , m_opts(opts)
+    , m_cwnd(opts.maxWindow) {}
+
+  void start() {
+    m_t0 = time::steady_clock::now();
+    m_jobs.push_back(Job{m_opts.remote, m_opts.local});
+    startJobs();
+  }
+
+  bool printStats() const {
+    double duration = time::duration_cast<time::microseconds>(time::steady_clock::now() - m_t0)
+                        .count() /
+                      1e6;
+    std::cerr << "files-ok\t" << m_nFilesOk << '\n'
+              << "files-failed\t" << m_nFailed << '\n'
+              << "segments\t" << m_nSegments << '\n'
+              << "bytes\t" << m_nBytes << '\n'
+              << "seconds\t" << duration << '\n'
+              << "goodput-mbps\t" << m_nBytes * 8 / duration / 1e6 << '\n'
+              << "congestion-marks\t" << m_nMarks << '\n'
+              << "nacks\t" << m_nNacks << '\n'
+              << "timeouts\t" << m_nTimeouts << '\n'
+              << "window-decreases\t" << m_cwnd.nDecreases << std::endl;
+    return m_nFailed == 0;
+  }
+
+private:
+  // Start discovery of queued jobs, up to the parallel limit.
+  void startJobs() {
+    while (m_nActiveJobs < m_opts.parallel && !m_jobs.empty()) {
+      ++m_nActiveJobs;
+      discover(std::move(m_jobs.front()), 0);
+      m_jobs.pop_front();
+    }
+  }
+
+  void finishJob() {
+    --m_nActiveJobs;
+    startJobs();
+    pump();
+  }
+
+  void discover(Job job, int nRetries) {
+    Interest interest(Name(job.remote).append(metadataComponent));
+    interest.setCanBePrefix(true);
+    interest.setMustBeFresh(true);
+    interest.setInterestLifetime(m_opts.lifetime);
+    auto retry = [=](const char* reason, time::nanoseconds delay) {
+      if (nRetries >= m_opts.retries) {
+        fail(job, reason);
+        finishJob();
+        return;
+      }
+      m_sched.schedule(delay, [=] { discover(job, nRetries + 1); });
+    };
+    m_face.expressInterest(
+      interest,
+      [=](const Interest&, const Data& data) {
+        if (data.getContentType() == tlv::ContentType_Nack) {
+          fail(job, "not-found");
+          finishJob();
+          return;
+        }
+        onMetadata(job, data.getContent());
+      },
+      [=](const Interest&, const lp::Nack&) {
+        ++m_nNacks;
+        retry("nack", 500_ms);
+      },
+      [=](const Interest&) {
+        ++m_nTimeouts;
+        retry("timeout", 0_ns);
+      });
+  }
+
+  void onMetadata(const Job& job, const Block& content) {
+    auto t = std::make_shared<Transfer>();
+    t->job = job;
+    std::string error;
+    try {
+      error = t->md.decode(content);
+    } catch (const tlv::Error&) {
+      error = "bad-metadata";
+    }
+    if (error.empty() && t->md.isDir() && !m_opts.recursive) {
+      error = "is-directory";
+    }
+    if (error.empty()) {
+      error = t->md.isDir() ? prepareDir(*t) : prepareFile(*t);
+    }
+    if (!error.empty()) {
+      fail(job, error);
+      finishJob();
+      return;
+    }
+
+    if (t->md.isFile() && t->md.size == 0) {
+      complete(*t);
+      finishJob();
+      return;
+    }
+    m_transfers.push_back(std::move(t));
+    pump();
+  }
+
+  std::string prepareDir(Transfer& t) {
+    boost::system::error_code ec;
+    fs::create_directories(t.job.local, ec);
+    if (ec) {
+      return ec.message();
+    }
+    return "";
+  }
+
+  std::string prepareFile(Transfer& t) {
+    t.fd = ::open(t.job.local.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (t.fd < 0 || ::ftruncate(t.fd, t.md.size) != 0) {
+      return std::strerror(errno);
+    }
+    return "";
+  }
+
+  // Send Interests while the congestion window permits.
+  // Earlier transfers take precedence, so that files complete in order of discovery, and later
+  // transfers fill the window when earlier ones have no more segments to request.
+  void pump() {
+    while (m_nInFlight < m_cwnd.size()) {
+      auto it = std::find_if(m_transfers.begin(), m_transfers.end(),
+                             [](const auto& t) { return t->hasNext(); });
+      if (it == m_transfers.end()) {
+        return;
+      }
+      sendSegment(*it, (*it)->takeNext());
+    }
+  }
+
+  void sendSegment(std::shared_ptr<Transfer> t, uint64_t seg) {
+    Interest interest(Name(t->md.versioned).appendSegment(seg));
+    interest.setInterestLifetime(m_opts.lifetime);
+    auto sendTime = time::steady_clock::now();
+    ++m_nInFlight;
+    m_face.expressInterest(
+      interest,
+      [=](const Interest&, const Data& data) {
+        --m_nInFlight;
+        if (data.getCongestionMark() > 0) {
+          ++m_nMarks;
+          m_cwnd.onCongestion(sendTime);
+        } else {
+          m_cwnd.onData();
+        }
+        onSegment(*t, seg, data);
+        pump();
+      },
+      [=](const Interest&, const lp::Nack&) {
+        --m_nInFlight;
+        ++m_nNacks;
+        onLoss(*t, seg, sendTime, "nack");
+      },
+      [=](const Interest&) {
+        --m_nInFlight;
+        ++m_nTimeouts;
+        onLoss(*t, seg, sendTime, "timeout");
+      });
+  }
+
+  void onSegment(Transfer& t, uint64_t seg, const Data& data) {
+    if (!t.isActive) {
+      return;
+    }
+
+    const Block& content = data.getContent();
+    if (t.md.isFile()) {
+      auto sl = SegmentLimit::parse(data.getName(), t.md.size, t.md.segmentSize);
+      if (content.value_size() != sl.segLen) {
+        abortTransfer(t, "bad-segment");
+        return;
+      }
+      for (size_t offset = 0; offset < sl.segLen;) {
+        ssize_t n =
+          ::pwrite(t.fd, content.value() + offset, sl.segLen - offset, sl.seekTo + offset);
+        if (n < 0) {
+          abortTransfer(t, std::strerror(errno));
+          return;
+        }
+        offset += static_cast<size_t>(n);
+      }
+    } else {
+      if (!t.md.lastSeg) {
+        auto finalBlock = data.getFinalBlock();
+        if (!finalBlock || !finalBlock->isSegment()) {
+          abortTransfer(t, "bad-segment");
+          return;
+        }
+        t.md.lastSeg = finalBlock->toSegment();
+      }
+      t.listing.emplace(seg, std::string(content.value_begin(), content.value_end()));
+    }
+
+    ++m_nSegments;
+    m_nBytes += content.value_size();
+    if (++t.nReceived > *t.md.lastSeg) {
+      complete(t);
+      removeTransfer(t);
+    }
+  }
+
+  void onLoss(Transfer& t, uint64_t seg, time::steady_clock::time_point sendTime,
+              const char* reason) {
+    m_cwnd.onCongestion(sendTime);
+    if (t.isActive) {
+      if (++t.nRetries[seg] > m_opts.retries) {
+        abortTransfer(t, reason);
+      } else {
+        t.retxQueue.push_back(seg);
+      }
+    }
+    pump();
+  }
+
+  void complete(Transfer& t) {
+    t.isActive = false;
+    if (t.md.isDir()) {
+      completeDir(t);
+      return;
+    }
+
+    struct timespec mtime;
+    mtime.tv_sec = t.md.mtime / 1000000000;
+    mtime.tv_nsec = t.md.mtime % 1000000000;
+    struct timespec times[2] = {mtime, mtime};
+    ::futimens(t.fd, times);
+    ::fchmod(t.fd, t.md.mode & 07777);
+    ::close(t.fd);
+    t.fd = -1;
+    ++m_nFilesOk;
+    std::cout << "FILE-OK" << '\t' << t.job.local.string() << '\t' << t.md.size << std::endl;
+  }
+
+  // Queue entries of a directory listing.
+  // Entries are checked to be single path components, so that a listing cannot direct writes
+  // outside the local directory.
+  void completeDir(Transfer& t) {
+    std::string payload;
+    for (const auto& [seg, chunk] : t.listing) {
+      payload += chunk;
+    }
+    t.listing.clear();
+
+    size_t nEntries = 0;
+    for (size_t pos = 0, end; pos < payload.size(); pos = end + 1) {
+      end = std::min(payload.find('\0', pos), payload.size());
+      std::string entry = payload.substr(pos, end - pos);
+      if (!entry.empty() && entry.back() == '/') {
+        entry.pop_back();
+      }
+      if (entry.empty() || entry == "." || entry == ".." || entry.find('/') != std::string::npos) {
+        continue;
+      }
+      name::Component comp(ndn::make_span(reinterpret_cast<const uint8_t*>(entry.data()),
+                                          entry.size()));
+      m_jobs.push_back(Job{Name(t.job.remote).append(comp), t.job.local / entry});
+      ++nEntries;
+    }
+    std::cout << "DIR-OK" << '\t' << t.job.local.string() << '\t' << nEntries << std::endl;
+  }
+
+  // Fail an active transfer. Its outstanding Interests are ignored when they return.
+  void abortTransfer(Transfer& t, const std::string& reason) {
+    t.isActive = false;
+    if (t.fd >= 0) {
+      ::close(t.fd);
+      t.fd = -1;
+      ::unlink(t.job.local.c_str());
+    }
+    fail(t.job, reason);
+    removeTransfer(t);
+  }
+
+  void removeTransfer(Transfer& t) {
+    m_transfers.erase(std::find_if(m_transfers.begin(), m_transfers.end(),
+                                   [&](const auto& p) { return p.get() == &t; }));
+    finishJob();
+  }
+
+  void fail(const Job& job, const std::string& reason) {
+    ++m_nFailed;
+    std::cerr << "ERROR" << '\t' << job.remote << '\t' << reason << std::endl;
+  }
+
+private:
+  Face& m_face;
+  Scheduler m_sched;
+  Options m_opts;
+  CongestionWindow m_cwnd;
+
+  std::deque<Job> m_jobs;
+  size_t m_nActiveJobs = 0;
+  std::vector<std::shared_ptr<Transfer>> m_transfers;
+  size_t m_nInFlight = 0;
+
+  time::steady_clock::time_point m_t0;
+  uint64_t m_nFilesOk = 0;
+  uint64_t m_nFailed = 0;
+  uint64_t m_nSegments = 0;
+  uint64_t m_nBytes = 0;
+  uint64_t m_nMarks = 0;
+  uint64_t m_nNacks = 0;
+  uint64_t m_nTimeouts = 0;
+};
+
+int
+main(int argc, char** argv) {
+  Options opts;
+  int lifetime = 4000;
+  auto args = parseProgramOptions(
+    argc, argv,
+    "Usage: ndn6-file-client /prefix/subdir/file.txt -o file.txt\n"
+    "       ndn6-file-client -r /prefix/subdir -o /local/dir\n"
+    "\n"
+    "Retrieve files from ndn6-file-server.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("name", po::value(&opts.remote)->required(), "remote name");
+      addOption("output,o", po::value(&opts.local), "local path");
+      addOption("recursive,r", po::bool_switch(&opts.recursive), "mirror a directory tree");
+      addOption("window,w", po::value(&opts.maxWindow)->default_value(opts.maxWindow),
+                "maximum Interests in flight");
+      addOption("parallel,P", po::value(&opts.parallel)->default_value(opts.parallel),
+                "maximum files in flight");
+      addOption("lifetime", po::value(&lifetime)->default_value(lifetime),
+                "Interest lifetime (milliseconds)");
+      addOption("retries", po::value(&opts.retries)->default_value(opts.retries),
+                "maximum retransmissions per segment");
+    },
+    "name", 1);
+  opts.lifetime = time::milliseconds(lifetime);
+  opts.parallel = std::max<size_t>(opts.parallel, 1);
+
+  if (args.count("output") == 0) {
+    if (opts.remote.empty()) {
+      std::cerr << "--output is required" << std::endl;
+      return 2;
+    }
+    const auto& last = opts.remote[-1];
+    opts.local = std::string(reinterpret_cast<const char*>(last.value()), last.value_size());
+  }
+
+  Face face(nullptr, getKeyChain());
+  Client client(face, opts);
+  client.start();
+  face.processEvents();
+  return client.printStats() ? 0 : 1;
+}
+
+} // namespace ndn6::file_client
+
+int
+main(int argc, char** argv) {
+  return ndn6::file_client::main(argc, argv);
+}
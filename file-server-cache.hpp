@@ -0,0 +1,211 @@
+#ifndef NDN6_TOOLS_FILE_SERVER_CACHE_HPP
+#define NDN6_TOOLS_FILE_SERVER_CACHE_HPP
+
+#include "common.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn6::file_server {
+
+namespace fs = boost::filesystem;
+
+// A snapshot file starts with an 8-octet magic string, followed by a header TLV element supplied
+// by the caller, followed by Data packets in TLV format, most recently used first.
+static const char SNAPSHOT_MAGIC[8] = {'N', 'D', 'N', '6', 'F', 'S', 'C', '2'};
+
+// LRU cache of signed segment packets, which can be saved to and restored from a snapshot file.
+//
+// Restored packets stay in the mmapped snapshot, indexed by name, and are decoded when first
+// requested. The caller must check that the Interest name carries the current version of the
+// file before lookup; since the version is derived from the file's mtime, a packet of a
+// modified file is never found, and its bytes are never touched.
+class SegmentCache : boost::noncopyable {
+public:
+  explicit SegmentCache(size_t capacity)
+    : m_capacity(capacity) {}
+
+  ~SegmentCache() {
+    unmapSnapshot();
+  }
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  // Find a packet, and mark it as most recently used.
+  const Data* find(const Name& name) {
+    if (auto it = m_index.find(name); it != m_index.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      return &m_lru.front();
+    }
+
+    auto it = m_snapshot.find(name);
+    if (it == m_snapshot.end()) {
+      return nullptr;
+    }
+    Data data;
+    try {
+      data.wireDecode(Block(it->second));
+    } catch (const tlv::Error&) {
+      m_snapshot.erase(it);
+      return nullptr;
+    }
+    m_snapshot.erase(it);
+    ++nRestored;
+    insert(data);
+    if (m_snapshot.empty()) {
+      unmapSnapshot();
+    }
+    return &m_lru.front();
+  }
+
+  void insert(const Data& data) {
+    if (m_capacity == 0 || m_index.count(data.getName()) > 0) {
+      return;
+    }
+    m_lru.push_front(data);
+    m_index.emplace(data.getName(), m_lru.begin());
+    while (m_lru.size() > m_capacity) {
+      m_index.erase(m_lru.back().getName());
+      m_lru.pop_back();
+    }
+  }
+
+  // Map a snapshot file and index its packets by name.
+  // A missing file is not an error, because there is no snapshot before the first shutdown.
+  // The snapshot is discarded if its header differs from the given header.
+  // Returns number of indexed packets.
+  size_t loadSnapshot(const fs::path& path, const Block& header) {
+    unmapSnapshot();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      if (errno != ENOENT) {
+        std::cerr << "snapshot " << path.string() << ": " << std::strerror(errno) << std::endl;
+      }
+      return 0;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > sizeof(SNAPSHOT_MAGIC)) {
+      void* base = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (base != MAP_FAILED) {
+        m_base = static_cast<const uint8_t*>(base);
+        m_size = st.st_size;
+      }
+    }
+    ::close(fd);
+
+    if (m_base == nullptr || std::memcmp(m_base, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+      std::cerr << "snapshot " << path.string() << ": not a snapshot file" << std::endl;
+      unmapSnapshot();
+      return 0;
+    }
+
+    const uint8_t* end = m_base + m_size;
+    const uint8_t* pos = m_base + sizeof(SNAPSHOT_MAGIC);
+    if (static_cast<size_t>(end - pos) < header.size() ||
+        std::memcmp(pos, header.data(), header.size()) != 0) {
+      std::cerr << "snapshot " << path.string() << ": parameters changed, discarded" << std::endl;
+      unmapSnapshot();
+      return 0;
+    }
+    pos += header.size();
+
+    // index by reading TLV headers only; Data is the outer element, and Name is its first child
+    while (pos < end && m_snapshot.size() < m_capacity) {
+      auto it = pos;
+      uint32_t type = 0;
+      uint64_t length = 0;
+      if (!tlv::readType(it, end, type) || type != tlv::Data ||
+          !tlv::readVarNumber(it, end, length) || length > static_cast<uint64_t>(end - it)) {
+        break;
+      }
+      const uint8_t* next = it + length;
+
+      auto nameIt = it;
+      if (!tlv::readType(nameIt, next, type) || type != tlv::Name ||
+          !tlv::readVarNumber(nameIt, next, length) ||
+          length > static_cast<uint64_t>(next - nameIt)) {
+        break;
+      }
+      Name name(Block(ndn::span<const uint8_t>(it, nameIt + length)));
+      m_snapshot.emplace(std::move(name), ndn::span<const uint8_t>(pos, next));
+      pos = next;
+    }
+    if (m_snapshot.empty()) {
+      unmapSnapshot();
+    }
+    return m_snapshot.size();
+  }
+
+  // Write cached packets to a snapshot file: recently used packets first, followed by restored
+  // packets that have not been requested, up to capacity.
+  // The file is written under a temporary name and then renamed, so that an interrupted write
+  // leaves the previous snapshot intact. Returns number of written packets.
+  size_t writeSnapshot(const fs::path& path, const Block& header) const {
+    fs::path tmp = path;
+    tmp += ".tmp";
+    std::ofstream os(tmp.string(), std::ios::binary | std::ios::trunc);
+    os.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    os.write(reinterpret_cast<const char*>(header.data()), header.size());
+    size_t n = 0;
+    auto write = [&](ndn::span<const uint8_t> wire) {
+      os.write(reinterpret_cast<const char*>(wire.data()), wire.size());
+      ++n;
+    };
+    for (const Data& data : m_lru) {
+      const Block& wire = data.wireEncode();
+      write({wire.data(), wire.size()});
+    }
+    for (auto it = m_snapshot.begin(); it != m_snapshot.end() && n < m_capacity; ++it) {
+      write(it->second);
+    }
+    os.close();
+
+    boost::system::error_code ec;
+    if (os) {
+      fs::rename(tmp, path, ec);
+    }
+    if (!os || ec) {
+      std::cerr << "snapshot " << path.string() << ": write error" << std::endl;
+      fs::remove(tmp, ec);
+      return 0;
+    }
+    return n;
+  }
+
+private:
+  void unmapSnapshot() {
+    m_snapshot.clear();
+    if (m_base != nullptr) {
+      ::munmap(const_cast<uint8_t*>(m_base), m_size);
+      m_base = nullptr;
+      m_size = 0;
+    }
+  }
+
+public:
+  uint64_t nRestored = 0;
+
+private:
+  size_t m_capacity;
+  std::list<Data> m_lru;
+  std::unordered_map<Name, std::list<Data>::iterator> m_index;
+
+  const uint8_t* m_base = nullptr;
+  size_t m_size = 0;
+  std::unordered_map<Name, ndn::span<const uint8_t>> m_snapshot;
+};
+
+} // namespace ndn6::file_server
+
+#endif // NDN6_TOOLS_FILE_SERVER_CACHE_HPP
@@ -0,0 +1,646 @@
+#ifndef NDN6_TOOLS_FILE_SERVER_HPP
+#define NDN6_TOOLS_FILE_SERVER_HPP
+
+#include "common.hpp"
+#include "file-server-cache.hpp"
+#include "probes.hpp"
+
+#include <boost/asio/signal_set.hpp>
+#include <boost/filesystem.hpp>
+
+#include <deque>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn6::file_server {
+
+namespace fs = boost::filesystem;
+
+static const uint32_t STATX_REQUIRED = STATX_TYPE | STATX_MODE | STATX_MTIME | STATX_SIZE;
+static const uint32_t STATX_OPTIONAL = STATX_ATIME | STATX_CTIME | STATX_BTIME;
+static const name::Component lsComponent(ndn::tlv::KeywordNameComponent, {'l', 's'});
+static const name::Component metadataComponent(ndn::tlv::KeywordNameComponent,
+                                               {'m', 'e', 't', 'a', 'd', 'a', 't', 'a'});
+static const name::Component manifestComponent(ndn::tlv::KeywordNameComponent,
+                                               {'m', 'a', 'n', 'i', 'f', 'e', 's', 't'});
+
+static const auto nSegments = Metrics::get().counter("segments-served");
+static const auto nMetadata = Metrics::get().counter("metadata-served");
+static const auto nManifests = Metrics::get().counter("manifests-served");
+static const auto nCacheHits = Metrics::get().counter("cache-hits");
+static const auto nNotFound = Metrics::get().counter("not-found");
+static const auto segmentLatency = Metrics::get().histogram("segment-latency");
+
+enum {
+  TtSegmentSize = 0xF500,
+  TtSize = 0xF502,
+  TtMode = 0xF504,
+  TtAtime = 0xF506,
+  TtBtime = 0xF508,
+  TtCtime = 0xF50A,
+  TtMtime = 0xF50C,
+  TtManifestSegments = 0xF50E,
+  TtSnapshotHeader = 0xF510,
+};
+
+// Largest number of segment digests that fits in a manifest packet.
+static const int MAX_MANIFEST_SEGMENTS = 240;
+
+class SegmentLimit {
+public:
+  static SegmentLimit parse(const Name& name, uint64_t size, uint64_t segmentSize) {
+    SegmentLimit sl;
+    if (size == 0) {
+      sl.ok = true;
+      return sl;
+    }
+
+    sl.segment = name[-1].toSegment();
+    sl.seekTo = sl.segment * segmentSize;
+    sl.lastSeg = computeLastSeg(size, segmentSize);
+    sl.segLen =
+      sl.segment == sl.lastSeg && size % segmentSize != 0 ? size % segmentSize : segmentSize;
+    sl.ok = sl.segment <= sl.lastSeg;
+    return sl;
+  }
+
+  static uint64_t computeLastSeg(uint64_t size, uint64_t segmentSize) {
+    return size / segmentSize + static_cast<uint64_t>(size % segmentSize != 0) -
+           static_cast<uint64_t>(size > 0);
+  }
+
+public:
+  bool ok = false;
+  uint64_t segment = 0;
+  uint64_t seekTo = 0;
+  uint64_t segLen = 0;
+  uint64_t lastSeg = 0;
+};
+
+// Path printed in the quoted format of fs::path, without copying it.
+struct QuotedPath {
+  const std::string& path;
+};
+
+inline std::ostream&
+operator<<(std::ostream& os, const QuotedPath& p) {
+  os << '"';
+  for (char c : p.path) {
+    if (c == '"' || c == '&') {
+      os << '&';
+    }
+    os << c;
+  }
+  return os << '"';
+}
+
+class FileInfo {
+public:
+  // Build path from components [begin, end) of name, and stat the file. Each component is one
+  // path element. The path buffer is reused, so that a request does not allocate.
+  bool prepare(const std::string& mountpoint, const Name& name, size_t begin, size_t end,
+               uint64_t segmentSize) {
+    this->segmentSize = segmentSize;
+
+    path = mountpoint;
+    for (size_t i = begin; i < end; ++i) {
+      std::string_view elem(reinterpret_cast<const char*>(name[i].value()), name[i].value_size());
+      if (elem.empty()) {
+        continue;
+      }
+      if (elem == "." || elem == ".." ||
+          elem.find_first_of(std::string_view("/\0", 2)) != std::string_view::npos) {
+        return reset();
+      }
+      if (path.empty() || path.back() != '/') {
+        path.push_back('/');
+      }
+      path.append(elem);
+    }
+
+    int res = statx(-1, path.c_str(), 0, STATX_REQUIRED | STATX_OPTIONAL, &st);
+    if (res != 0 || !has(STATX_REQUIRED)) {
+      return reset();
+    }
+    return true;
+  }
+
+  size_t size() const {
+    return st.stx_size;
+  }
+
+  bool isFile() const {
+    return S_ISREG(st.stx_mode);
+  }
+
+  bool isDir() const {
+    return S_ISDIR(st.stx_mode);
+  }
+
+  uint64_t mtime() const {
+    return timestamp(st.stx_mtime);
+  }
+
+  QuotedPath quotedPath() const {
+    return QuotedPath{path};
+  }
+
+  // Check the version component in place, in lieu of building the versioned name.
+  bool checkVersion(const name::Component& comp) const {
+    return comp.isVersion() && comp.toVersion() == mtime();
+  }
+
+  // Build versioned name under serve prefix, from components [begin, end) of name.
+  void makeVersioned(const Name& servePrefix, const Name& name, size_t begin, size_t end) {
+    versioned = servePrefix;
+    for (size_t i = begin; i < end; ++i) {
+      versioned.append(name[i]);
+    }
+    if (isDir()) {
+      versioned.append(lsComponent);
+    }
+    versioned.appendVersion(mtime());
+  }
+
+  Block buildMetadata() const {
+    Block content(tlv::Content);
+    content.push_back(versioned.wireEncode());
+    if (isFile()) {
+      Block finalBlockId(tlv::FinalBlockId);
+      uint64_t lastSeg = SegmentLimit::computeLastSeg(size(), segmentSize);
+      finalBlockId.push_back(name::Component::fromSegment(lastSeg).wireEncode());
+      finalBlockId.encode();
+      content.push_back(finalBlockId);
+      content.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtSegmentSize, segmentSize));
+      content.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtSize, size()));
+      if (manifestSegments > 0) {
+        content.push_back(
+          ndn::encoding::makeNonNegativeIntegerBlock(TtManifestSegments, manifestSegments));
+      }
+    }
+    content.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtMode, st.stx_mode));
+    if (has(STATX_ATIME)) {
+      content.push_back(
+        ndn::encoding::makeNonNegativeIntegerBlock(TtAtime, timestamp(st.stx_atime)));
+    }
+    if (has(STATX_BTIME)) {
+      content.push_back(
+        ndn::encoding::makeNonNegativeIntegerBlock(TtBtime, timestamp(st.stx_btime)));
+    }
+    if (has(STATX_CTIME)) {
+      content.push_back(
+        ndn::encoding::makeNonNegativeIntegerBlock(TtCtime, timestamp(st.stx_ctime)));
+    }
+    content.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtMtime, mtime()));
+    content.encode();
+    return content;
+  }
+
+private:
+  bool reset() {
+    path.clear();
+    st = {};
+    return false;
+  }
+
+  bool has(uint32_t bit) const {
+    return (st.stx_mask & bit) == bit;
+  }
+
+  uint64_t timestamp(struct statx_timestamp t) const {
+    return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+  }
+
+public:
+  std::string path;
+  struct statx st = {};
+  Name versioned;
+  uint64_t segmentSize;
+  uint64_t manifestSegments = 0;
+};
+
+struct Options {
+  Name servePrefix;
+  Name discoveryPrefix;
+  fs::path directory;
+  int segmentSize = 6144;
+  int manifestSegments = 0;
+  size_t cacheSegments = 0;
+  fs::path snapshot;
+  Name metricsPrefix;
+};
+
+inline Options
+parseOptions(const std::vector<std::string>& args) {
+  Options opts;
+  auto vm = parseProgramOptions(
+    args,
+    "Usage: ndn6-file-server\n"
+    "\n"
+    "Serve files from a directory.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("listen,b", po::value(&opts.servePrefix)->required(), "serve prefix");
+      addOption("discovery,D", po::value(&opts.discoveryPrefix), "discovery prefix");
+      addOption("directory,d", po::value(&opts.directory)->required(), "local directory");
+      addOption("segment-size,s", po::value(&opts.segmentSize)->notifier([](uint64_t v) {
+        if (!(v >= 1 && v <= 8192)) {
+          throw std::range_error("segment-size must be between 1 and 8192");
+        }
+      }),
+                "segment size");
+      addOption("manifest-segments",
+                po::value(&opts.manifestSegments)->notifier([](int v) {
+                  if (!(v >= 0 && v <= MAX_MANIFEST_SEGMENTS)) {
+                    throw std::range_error("manifest-segments must be between 0 and 240");
+                  }
+                }),
+                "segments per signed manifest, 0 to sign every segment");
+      addOption("cache", po::value(&opts.cacheSegments), "cache this many signed segments");
+      addOption("snapshot", po::value(&opts.snapshot),
+                "save segment cache to this file upon termination, and restore upon startup");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    });
+  if (vm.count("discovery") == 0) {
+    opts.discoveryPrefix = opts.servePrefix;
+  }
+  if (!opts.snapshot.empty() && opts.cacheSegments == 0) {
+    throw UsageError("--snapshot requires --cache", "");
+  }
+  return opts;
+}
+
+class FileServer : public Service {
+public:
+  explicit FileServer(Face& face, KeyChain& keyChain, const Options& opts)
+    : m_face(face)
+    , m_signer(keyChain)
+    , m_digestSigner(keyChain, ndn::signingWithSha256())
+    , m_servePrefix(opts.servePrefix)
+    , m_discoveryPrefix(opts.discoveryPrefix)
+    , m_directory(opts.directory)
+    , m_segmentSize(opts.segmentSize)
+    , m_manifestSegments(opts.manifestSegments)
+    , m_payload(opts.segmentSize)
+    , m_cache(opts.cacheSegments)
+    , m_snapshot(opts.snapshot) {}
+
+  ~FileServer() override {
+    if (!m_snapshot.empty() && m_snapshotHeader.isValid()) {
+      size_t n = m_cache.writeSnapshot(m_snapshot, m_snapshotHeader);
+      std::cerr << "snapshot saved " << n << " segments" << std::endl;
+    }
+  }
+
+  void start() override {
+    // naming convention is process-wide
+    name::setConventionDecoding(name::Convention::TYPED);
+
+    std::vector<Name> prefixes{m_servePrefix};
+    if (!m_discoveryPrefix.equals(m_servePrefix)) {
+      prefixes.push_back(m_discoveryPrefix);
+    }
+    for (const Name& prefix : prefixes) {
+      m_face.registerPrefix(prefix, nullptr, abortOnRegisterFail);
+      bool isServe = prefix == m_servePrefix;
+      m_face.setInterestFilter(prefix, [this, isServe](const ndn::InterestFilter& filter,
+                                                       const Interest& interest) {
+        processInterest(filter, interest, isServe);
+      });
+    }
+
+    // restore snapshot; it is saved in the destructor, after SIGINT or SIGTERM stops the face
+    if (!m_snapshot.empty()) {
+      m_snapshotHeader = makeSnapshotHeader();
+      size_t n = m_cache.loadSnapshot(m_snapshot, m_snapshotHeader);
+      std::cerr << "snapshot loaded " << n << " segments" << std::endl;
+      m_stopSignal.emplace(m_face.getIoContext(), SIGINT, SIGTERM);
+      m_stopSignal->async_wait([this](const boost::system::error_code& ec, int) {
+        if (!ec) {
+          m_face.getIoContext().stop();
+        }
+      });
+    }
+  }
+
+private:
+  // Snapshot header records the parameters that determine segment encoding and signing, because
+  // cached segments made with other parameters would be mixed with new segments of the same
+  // versioned name.
+  Block makeSnapshotHeader() {
+    Block header(TtSnapshotHeader);
+    header.push_back(ndn::encoding::makeNonNegativeIntegerBlock(TtSegmentSize, m_segmentSize));
+    header.push_back(
+      ndn::encoding::makeNonNegativeIntegerBlock(TtManifestSegments, m_manifestSegments));
+    header.push_back(m_signer.getSignerName().wireEncode());
+    header.encode();
+    return header;
+  }
+
+  static bool isKeyword(const name::Component& comp) {
+    return comp == lsComponent || comp == metadataComponent || comp == manifestComponent;
+  }
+
+  // Dispatch by name components, which are examined in place. The name consists of prefix,
+  // relative path [begin, end) without keywords, and a suffix that starts with a keyword.
+  void processInterest(const ndn::InterestFilter& filter, const Interest& interest, bool isServe) {
+    const Name& name = interest.getName();
+    size_t begin = filter.getPrefix().size();
+    size_t end = begin;
+    while (end < name.size() && !isKeyword(name[end])) {
+      ++end;
+    }
+    size_t suffixLen = name.size() - end;
+
+    if (suffixLen == 1 && name[end] == metadataComponent) {
+      rdrFile(name, begin, end);
+      return;
+    }
+    if (suffixLen == 2 && name[end] == lsComponent && name[end + 1] == metadataComponent) {
+      rdrDir(name, begin, end);
+      return;
+    }
+
+    // segment Interests: relative path, optional keyword, version, segment
+    if (!isServe || name.empty() || !name[-1].isSegment()) {
+      return;
+    }
+    if (suffixLen == 0 && end - begin >= 2) {
+      readFile(interest, begin, end - 2);
+    } else if (suffixLen == 3 && name[end] == lsComponent) {
+      readDir(interest, begin, end);
+    } else if (suffixLen == 2 && name[end] == manifestComponent && end - begin >= 1 &&
+               m_manifestSegments > 0) {
+      readManifest(name, begin, end - 1);
+    }
+  }
+
+  // Stat the file or directory named by components [begin, end). FileInfo is reused.
+  FileInfo& parseInterestName(const Name& name, size_t begin, size_t end) {
+    m_info.prepare(m_directory.native(), name, begin, end, m_segmentSize);
+    m_info.manifestSegments = m_manifestSegments;
+    return m_info;
+  }
+
+  void rdrFile(const Name& name, size_t begin, size_t end) {
+    auto& info = parseInterestName(name, begin, end);
+    replyRdr("RDR-FILE", name, begin, end, info, info.isFile() || info.isDir());
+  }
+
+  void rdrDir(const Name& name, size_t begin, size_t end) {
+    auto& info = parseInterestName(name, begin, end);
+    replyRdr("RDR-DIR", name, begin, end, info, info.isDir());
+  }
+
+  void replyRdr(const char* act, const Name& name, size_t begin, size_t end, FileInfo& info,
+                bool found) {
+    if (!found) {
+      nNotFound.inc();
+      replyNack(name);
+      std::cout << act << "-NOT-FOUND" << '\t' << info.quotedPath() << std::endl;
+      return;
+    }
+
+    info.makeVersioned(m_servePrefix, name, begin, end);
+    Data data(Name(name).appendVersion().appendSegment(0));
+    data.setFreshnessPeriod(1_ms);
+    data.setFinalBlock(data.getName().get(-1));
+    data.setContent(info.buildMetadata());
+    m_signer.sign(data);
+    m_face.put(data);
+    nMetadata.inc();
+    std::cout << act << "-OK" << '\t' << info.quotedPath() << '\t' << info.versioned << std::endl;
+  }
+
+  void readFile(const Interest& interest, size_t begin, size_t end) {
+    const Name& name = interest.getName();
+    NDN6_PROBE(fs_interest, probeHash(name), interest.wireEncode().size());
+    auto& info = parseInterestName(name, begin, end);
+    if (!info.isFile() || !info.checkVersion(name[-2]) || replyCached(name)) {
+      return;
+    }
+
+    auto sl = SegmentLimit::parse(name, info.size(), m_segmentSize);
+    if (!sl.ok) {
+      return;
+    }
+
+    auto t0 = time::steady_clock::now();
+    int fd = ::open(info.path.c_str(), O_RDONLY | O_CLOEXEC);
+    bool ok = fd >= 0 && readPayload(fd, sl);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    if (!ok) {
+      std::cout << "READ-FILE-ERROR" << '\t' << info.quotedPath() << '\t' << sl.segment
+                << std::endl;
+      return;
+    }
+    replySegment("READ-FILE", name, info, sl, ndn::make_span(m_payload.data(), sl.segLen),
+                 m_manifestSegments > 0 ? m_digestSigner : m_signer, t0);
+  }
+
+  void readDir(const Interest& interest, size_t begin, size_t end) {
+    const Name& name = interest.getName();
+    NDN6_PROBE(fs_interest, probeHash(name), interest.wireEncode().size());
+    auto& info = parseInterestName(name, begin, end);
+    if (!info.isDir() || !info.checkVersion(name[-2]) || replyCached(name)) {
+      return;
+    }
+
+    auto t0 = time::steady_clock::now();
+    std::set<std::string> filenames;
+    try {
+      for (const auto& entry : fs::directory_iterator(info.path)) {
+        auto stat = entry.status();
+        if (fs::is_directory(stat)) {
+          filenames.insert(entry.path().filename().string() + "/");
+        } else if (fs::is_regular_file(stat)) {
+          filenames.insert(entry.path().filename().string());
+        }
+      }
+    } catch (const fs::filesystem_error& err) {
+      std::cout << "READ-DIR-ERROR" << '\t' << info.quotedPath() << '\t' << err.what()
+                << std::endl;
+      return;
+    }
+
+    std::string listing;
+    for (const auto& filename : filenames) {
+      listing.append(filename);
+      listing.push_back('\0');
+    }
+
+    auto sl = SegmentLimit::parse(name, listing.size(), m_segmentSize);
+    if (!sl.ok) {
+      return;
+    }
+
+    auto payload = reinterpret_cast<const uint8_t*>(listing.data()) + sl.seekTo;
+    replySegment("READ-DIR", name, info, sl, ndn::make_span(payload, sl.segLen), m_signer, t0);
+  }
+
+  // Manifest k lists implicit digests of segments [k*N, k*N+N) in order, where N is
+  // manifestSegments, as ImplicitSha256DigestComponent elements. Segments covered by manifests
+  // are signed with DigestSha256, so that one signature is computed per N segments.
+  void readManifest(const Name& name, size_t begin, size_t end) {
+    auto& info = parseInterestName(name, begin, end);
+    if (!info.isFile() || !info.checkVersion(name[-3])) {
+      return;
+    }
+    if (auto it = m_manifests.find(name); it != m_manifests.end()) {
+      m_face.put(it->second);
+      nManifests.inc();
+      return;
+    }
+
+    uint64_t lastSeg = SegmentLimit::computeLastSeg(info.size(), m_segmentSize);
+    uint64_t k = name[-1].toSegment();
+    if (k > lastSeg / m_manifestSegments) {
+      return;
+    }
+    uint64_t firstSeg = k * m_manifestSegments;
+    uint64_t endSeg = std::min(lastSeg + 1, firstSeg + m_manifestSegments);
+
+    int fd = ::open(info.path.c_str(), O_RDONLY | O_CLOEXEC);
+    Name versioned = name.getPrefix(-2);
+    Block content(tlv::Content);
+    for (uint64_t seg = firstSeg; seg < endSeg; ++seg) {
+      Data segment(Name(versioned).appendSegment(seg));
+      auto sl = SegmentLimit::parse(segment.getName(), info.size(), m_segmentSize);
+      if (fd < 0 || !readPayload(fd, sl)) {
+        std::cout << "READ-MANIFEST-ERROR" << '\t' << info.quotedPath() << '\t' << k
+                  << std::endl;
+        if (fd >= 0) {
+          ::close(fd);
+        }
+        return;
+      }
+      makeSegment(segment, sl, ndn::make_span(m_payload.data(), sl.segLen), m_digestSigner);
+      content.push_back(segment.getFullName()[-1].wireEncode());
+    }
+    ::close(fd);
+    content.encode();
+
+    Data data(name);
+    data.setFinalBlock(name::Component::fromSegment(lastSeg / m_manifestSegments));
+    data.setContent(content);
+    m_signer.sign(data);
+    m_face.put(data);
+    nManifests.inc();
+    std::cout << "READ-MANIFEST-OK" << '\t' << info.quotedPath() << '\t' << k << std::endl;
+
+    if (m_manifestOrder.size() >= MANIFEST_CACHE_CAPACITY) {
+      m_manifests.erase(m_manifestOrder.front());
+      m_manifestOrder.pop_front();
+    }
+    m_manifests.emplace(name, std::move(data));
+    m_manifestOrder.push_back(name);
+  }
+
+  // Reply from segment cache. The caller must have checked the version in the name, so that a
+  // segment of a modified file is not served.
+  bool replyCached(const Name& name) {
+    if (m_cache.capacity() == 0) {
+      return false;
+    }
+    const Data* data = m_cache.find(name);
+    if (data == nullptr) {
+      return false;
+    }
+    m_face.put(*data);
+    NDN6_PROBE(fs_put, probeHash(name), data->wireEncode().size());
+    nSegments.inc();
+    nCacheHits.inc();
+    return true;
+  }
+
+  // Read segment payload from file into m_payload. Returns false upon read error.
+  bool readPayload(int fd, const SegmentLimit& sl) {
+    for (uint64_t pos = 0; pos < sl.segLen;) {
+      ssize_t n = ::pread(fd, m_payload.data() + pos, sl.segLen - pos, sl.seekTo + pos);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      pos += static_cast<uint64_t>(n);
+    }
+    return true;
+  }
+
+  // Put payload into data, and sign it.
+  // The encoding must be deterministic, because manifests carry digests of segment packets.
+  void makeSegment(Data& data, const SegmentLimit& sl, ndn::span<const uint8_t> payload,
+                   CachedSigner& signer) {
+    // consecutive segments of a file share FinalBlockId, so that its encoding is reused
+    if (m_finalBlockSeg != sl.lastSeg || m_finalBlock.empty()) {
+      m_finalBlock = name::Component::fromSegment(sl.lastSeg);
+      m_finalBlockSeg = sl.lastSeg;
+    }
+    data.setFinalBlock(m_finalBlock);
+    data.setContent(payload);
+    signer.sign(data);
+  }
+
+  // Reply with a segment built in the pooled m_segment packet, whose name buffer is reused.
+  // Probes are fired here rather than in makeSegment, so that segments built for a manifest are
+  // not counted as request stages.
+  void replySegment(const char* act, const Name& name, const FileInfo& info, const SegmentLimit& sl,
+                    ndn::span<const uint8_t> payload, CachedSigner& signer,
+                    time::steady_clock::time_point t0) {
+    NDN6_PROBE(fs_read, probeHash(name), sl.segLen);
+    m_segment.setName(name);
+    makeSegment(m_segment, sl, payload, signer);
+    NDN6_PROBE(fs_sign, probeHash(name), m_segment.wireEncode().size());
+    m_face.put(m_segment);
+    NDN6_PROBE(fs_put, probeHash(name), m_segment.wireEncode().size());
+    m_cache.insert(m_segment);
+    nSegments.inc();
+    segmentLatency.observeSince(t0);
+    std::cout << act << "-OK" << '\t' << info.quotedPath() << '\t' << sl.segment << std::endl;
+  }
+
+  void replyNack(const Name& name) {
+    Data data(name);
+    data.setContentType(tlv::ContentType_Nack);
+    data.setFreshnessPeriod(1_ms);
+    m_signer.sign(data);
+    m_face.put(data);
+  }
+
+private:
+  Face& m_face;
+  CachedSigner m_signer;
+  CachedSigner m_digestSigner;
+  Name m_servePrefix;
+  Name m_discoveryPrefix;
+  fs::path m_directory;
+  uint64_t m_segmentSize;
+  uint64_t m_manifestSegments;
+
+  static constexpr size_t MANIFEST_CACHE_CAPACITY = 64;
+  std::map<Name, Data> m_manifests;
+  std::deque<Name> m_manifestOrder;
+
+  // buffers reused across requests
+  FileInfo m_info;
+  std::vector<uint8_t> m_payload;
+  Data m_segment;
+  name::Component m_finalBlock;
+  uint64_t m_finalBlockSeg = 0;
+
+  SegmentCache m_cache;
+  fs::path m_snapshot;
+  Block m_snapshotHeader;
+  std::optional<boost::asio::signal_set> m_stopSignal;
+};
+
+} // namespace ndn6::file_server
+
+#endif // NDN6_TOOLS_FILE_SERVER_HPP
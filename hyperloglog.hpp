@@ -0,0 +1,54 @@
+#ifndef NDN6_TOOLS_HYPERLOGLOG_HPP
+#define NDN6_TOOLS_HYPERLOGLOG_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace ndn6 {
+
+// HyperLogLog distinct count estimator with 2^10 one-octet registers.
+// Standard error is about 3.3%. Input must be a well-mixed 64-bit hash.
+class HyperLogLog {
+public:
+  static constexpr int PRECISION = 10;
+  static constexpr size_t N_REGISTERS = size_t(1) << PRECISION;
+
+  void clear() {
+    m_registers.fill(0);
+  }
+
+  void add(uint64_t hash) {
+    size_t index = hash >> (64 - PRECISION);
+    uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > m_registers[index]) {
+      m_registers[index] = rank;
+    }
+  }
+
+  double estimate() const {
+    double sum = 0;
+    size_t nZeros = 0;
+    for (uint8_t r : m_registers) {
+      sum += std::ldexp(1.0, -r);
+      nZeros += static_cast<size_t>(r == 0);
+    }
+
+    constexpr double m = N_REGISTERS;
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double e = alpha * m * m / sum;
+    if (e <= 2.5 * m && nZeros > 0) {
+      // small range correction: linear counting
+      e = m * std::log(m / nZeros);
+    }
+    return e;
+  }
+
+private:
+  std::array<uint8_t, N_REGISTERS> m_registers{};
+};
+
+} // namespace ndn6
+
+#endif // NDN6_TOOLS_HYPERLOGLOG_HPP
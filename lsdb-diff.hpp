@@ -0,0 +1,161 @@
+#ifndef NDN6_TOOLS_LSDB_DIFF_HPP
+#define NDN6_TOOLS_LSDB_DIFF_HPP
+
+#include "common.hpp"
+
+#include <string_view>
+
+namespace ndn6 {
+
+// Incremental diff of NLSR names dataset.
+// Each NameLsa is identified by its origin router, and hashed over its name elements, which
+// excludes SequenceNumber and ExpirationTime. Names in an LSA whose hash is unchanged since
+// the previous dataset are not decoded again.
+class LsdbDiff {
+public:
+  using Callback = std::function<void(const Name&)>;
+
+  enum {
+    TtLsa = 0x80,
+    TtPrefixInfo = 0x92,
+  };
+
+  // Apply a complete dataset.
+  // onAdvertise is invoked for each name that newly appears in any LSA.
+  // onWithdraw is invoked for each name that no longer appears in any LSA.
+  void apply(const std::vector<Block>& lsas, const Callback& onAdvertise,
+             const Callback& onWithdraw) {
+    ++m_generation;
+    m_nParsed = m_nSkipped = 0;
+    for (size_t i = 0; i < lsas.size(); ++i) {
+      applyLsa(lsas[i], i, onAdvertise);
+    }
+
+    for (auto it = m_lsas.begin(); it != m_lsas.end();) {
+      if (it->second.generation == m_generation) {
+        ++it;
+        continue;
+      }
+      std::move(it->second.names.begin(), it->second.names.end(),
+                std::back_inserter(m_released));
+      it = m_lsas.erase(it);
+    }
+
+    // names are released after all LSAs are processed, so that a name moving between LSAs
+    // does not cause a withdrawal
+    for (const auto& name : m_released) {
+      release(name, onWithdraw);
+    }
+    m_released.clear();
+  }
+
+  bool has(const Name& name) const {
+    return m_refCount.count(name) > 0;
+  }
+
+  size_t size() const {
+    return m_refCount.size();
+  }
+
+  size_t getLsaCount() const {
+    return m_lsas.size();
+  }
+
+  // Number of LSAs decoded during last apply.
+  size_t getParsedCount() const {
+    return m_nParsed;
+  }
+
+  // Number of LSAs skipped due to unchanged hash during last apply.
+  size_t getSkippedCount() const {
+    return m_nSkipped;
+  }
+
+private:
+  void applyLsa(const Block& lsa, size_t index, const Callback& onAdvertise) {
+    Name origin;
+    size_t hash = 0;
+    try {
+      lsa.parse();
+      for (const auto& element : lsa.elements()) {
+        if (element.type() == TtLsa) {
+          element.parse();
+          origin = Name(element.get(tlv::Name));
+          continue;
+        }
+        std::string_view wire(reinterpret_cast<const char*>(element.data()), element.size());
+        hash = hash * 1099511628211ULL ^ std::hash<std::string_view>()(wire);
+      }
+    } catch (const tlv::Error&) {
+      return;
+    }
+    if (origin.empty()) {
+      origin.appendNumber(index);
+    }
+
+    auto& record = m_lsas[origin];
+    if (record.generation > 0 && record.hash == hash) {
+      record.generation = m_generation;
+      ++m_nSkipped;
+      return;
+    }
+
+    std::vector<Name> names;
+    try {
+      for (const auto& element : lsa.elements()) {
+        switch (element.type()) {
+          case tlv::Name:
+            names.emplace_back(element);
+            break;
+          case TtPrefixInfo:
+            element.parse();
+            names.emplace_back(element.get(tlv::Name));
+            break;
+        }
+      }
+    } catch (const tlv::Error&) {
+      record.generation = m_generation;
+      return;
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    ++m_nParsed;
+
+    for (const auto& name : names) {
+      if (++m_refCount[name] == 1) {
+        onAdvertise(name);
+      }
+    }
+    std::move(record.names.begin(), record.names.end(), std::back_inserter(m_released));
+    record.names = std::move(names);
+    record.hash = hash;
+    record.generation = m_generation;
+  }
+
+  void release(const Name& name, const Callback& onWithdraw) {
+    auto it = m_refCount.find(name);
+    if (it == m_refCount.end() || --it->second > 0) {
+      return;
+    }
+    m_refCount.erase(it);
+    onWithdraw(name);
+  }
+
+private:
+  struct LsaRecord {
+    uint64_t generation = 0;
+    size_t hash = 0;
+    std::vector<Name> names;
+  };
+
+  uint64_t m_generation = 0;
+  std::map<Name, LsaRecord> m_lsas;
+  std::map<Name, size_t> m_refCount;
+  std::vector<Name> m_released;
+  size_t m_nParsed = 0;
+  size_t m_nSkipped = 0;
+};
+
+} // namespace ndn6
+
+#endif // NDN6_TOOLS_LSDB_DIFF_HPP
@@ -0,0 +1,79 @@
+#ifndef NDN6_TOOLS_NAME_TRIE_HPP
+#define NDN6_TOOLS_NAME_TRIE_HPP
+
+#include "common.hpp"
+
+#include <map>
+
+namespace ndn6 {
+
+// Set of name prefixes organized as a name component trie.
+// A lookup descends one level per name component, with an ordered map lookup at each level,
+// so its cost is O(name length * log fanout) component comparisons, rather than a scan over all
+// inserted prefixes.
+class NameTrie {
+public:
+  void insert(const Name& prefix) {
+    Node* node = &m_root;
+    for (const auto& comp : prefix) {
+      auto& child = node->children[comp];
+      if (child == nullptr) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+    }
+    m_size += static_cast<size_t>(!node->isPrefix);
+    node->isPrefix = true;
+  }
+
+  // Determine whether any inserted prefix is a prefix of name.
+  bool covers(const Name& name) const {
+    return findLongestPrefixLength(name).has_value();
+  }
+
+  // Return length of the longest inserted prefix of name, or nullopt if none matches.
+  std::optional<size_t> findLongestPrefixLength(const Name& name) const {
+    std::optional<size_t> found;
+    const Node* node = &m_root;
+    for (size_t i = 0;; ++i) {
+      if (node->isPrefix) {
+        found = i;
+      }
+      if (i == name.size()) {
+        break;
+      }
+      auto it = node->children.find(name[i]);
+      if (it == node->children.end()) {
+        break;
+      }
+      node = it->second.get();
+    }
+    return found;
+  }
+
+  size_t size() const {
+    return m_size;
+  }
+
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  void clear() {
+    m_root = Node();
+    m_size = 0;
+  }
+
+private:
+  struct Node {
+    bool isPrefix = false;
+    std::map<name::Component, std::unique_ptr<Node>> children;
+  };
+
+  Node m_root;
+  size_t m_size = 0;
+};
+
+} // namespace ndn6
+
+#endif // NDN6_TOOLS_NAME_TRIE_HPP
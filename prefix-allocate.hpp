@@ -0,0 +1,554 @@
+#ifndef NDN6_TOOLS_PREFIX_ALLOCATE_HPP
+#define NDN6_TOOLS_PREFIX_ALLOCATE_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/mgmt/nfd/face-monitor.hpp>
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace ndn6::prefix_allocate {
+
+static const int ORIGIN_ALLOCATE = 22804;
+
+struct Lease {
+  Name prefix;
+  time::system_clock::time_point expiry = time::system_clock::time_point::max();
+};
+
+struct FaceLeases {
+  std::deque<Lease> leases; // oldest first
+  std::map<Name, std::vector<Interest>> inFlight; // prefix => Interests awaiting registration
+  int lastTimestamp = 0;
+};
+
+using LeaseTable = std::unordered_map<uint64_t, FaceLeases>;
+
+// Append-only lease log. Each line is one of:
+//   A <faceId> <expiry in Unix milliseconds, 0 for none> <prefix>   add or renew a lease
+//   D <faceId> <prefix>                                            delete a lease
+//   F <faceId>                                                     delete all leases of a face
+// The file is rewritten with only live leases upon startup and when it grows too large.
+class LeaseLog : boost::noncopyable {
+public:
+  explicit LeaseLog(std::string filename)
+    : m_filename(std::move(filename)) {}
+
+  // Replay the log into a table. Expired leases are skipped.
+  LeaseTable load() const {
+    LeaseTable table;
+    std::ifstream file(m_filename);
+    std::string line;
+    while (std::getline(file, line)) {
+      std::istringstream is(line);
+      char op = 0;
+      uint64_t faceId = 0;
+      is >> op >> faceId;
+      if (!is) {
+        continue;
+      }
+      try {
+        switch (op) {
+          case 'A': {
+            uint64_t expiry = 0;
+            std::string uri;
+            is >> expiry >> uri;
+            Lease lease{Name(uri)};
+            if (expiry > 0) {
+              lease.expiry = time::fromUnixTimestamp(time::milliseconds(expiry));
+            }
+            auto& leases = table[faceId].leases;
+            removePrefix(leases, lease.prefix);
+            leases.push_back(std::move(lease));
+            break;
+          }
+          case 'D': {
+            std::string uri;
+            is >> uri;
+            removePrefix(table[faceId].leases, Name(uri));
+            break;
+          }
+          case 'F':
+            table.erase(faceId);
+            break;
+        }
+      } catch (const tlv::Error&) {
+        continue;
+      }
+    }
+
+    auto now = time::system_clock::now();
+    for (auto it = table.begin(); it != table.end();) {
+      auto& leases = it->second.leases;
+      leases.erase(std::remove_if(leases.begin(), leases.end(),
+                                  [now](const Lease& lease) { return lease.expiry <= now; }),
+                   leases.end());
+      it = leases.empty() ? table.erase(it) : std::next(it);
+    }
+    return table;
+  }
+
+  // Replace the log with live leases, and reopen it for appending.
+  void rewrite(const LeaseTable& table) {
+    std::string tmp = m_filename + ".tmp";
+    {
+      std::ofstream file(tmp, std::ios::trunc);
+      m_nLive = 0;
+      for (const auto& [faceId, fl] : table) {
+        for (const auto& lease : fl.leases) {
+          writeAdd(file, faceId, lease);
+          ++m_nLive;
+        }
+      }
+      if (!file) {
+        std::cerr << "LeaseLog write error " << tmp << std::endl;
+        return;
+      }
+    }
+    if (std::rename(tmp.data(), m_filename.data()) != 0) {
+      std::cerr << "LeaseLog rename error " << m_filename << std::endl;
+      return;
+    }
+    m_nLines = m_nLive;
+    m_file.close();
+    m_file.open(m_filename, std::ios::app);
+  }
+
+  void add(uint64_t faceId, const Lease& lease) {
+    writeAdd(m_file, faceId, lease);
+    m_file.flush();
+    ++m_nLines;
+  }
+
+  void remove(uint64_t faceId, const Name& prefix) {
+    m_file << "D " << faceId << ' ' << prefix << '\n' << std::flush;
+    ++m_nLines;
+  }
+
+  void removeFace(uint64_t faceId) {
+    m_file << "F " << faceId << '\n' << std::flush;
+    ++m_nLines;
+  }
+
+  // Whether the log has accumulated enough obsolete lines to be worth rewriting.
+  bool needsRewrite(size_t nLive) const {
+    return m_nLines > 2 * nLive + 1024;
+  }
+
+private:
+  static void writeAdd(std::ostream& os, uint64_t faceId, const Lease& lease) {
+    uint64_t expiry = lease.expiry == time::system_clock::time_point::max()
+                        ? 0
+                        : time::toUnixTimestamp(lease.expiry).count();
+    os << "A " << faceId << ' ' << expiry << ' ' << lease.prefix << '\n';
+  }
+
+  static void removePrefix(std::deque<Lease>& leases, const Name& prefix) {
+    leases.erase(std::remove_if(leases.begin(), leases.end(),
+                                [&](const Lease& lease) { return lease.prefix == prefix; }),
+                 leases.end());
+  }
+
+private:
+  std::string m_filename;
+  std::ofstream m_file;
+  size_t m_nLines = 0;
+  size_t m_nLive = 0;
+};
+
+class PrefixAllocate : public Service {
+public:
+  struct Options {
+    Name prefix;
+    time::seconds leaseDuration = 0_s; // 0 means leases do not expire
+    size_t maxLeasesPerFace = 1;
+    std::string stateFile;
+    Name metricsPrefix;
+  };
+
+  static constexpr size_t RECONCILE_WINDOW = 16;
+  static constexpr time::seconds RECONCILE_MAX_RETRY_DELAY = 60_s;
+  static constexpr time::seconds REPLY_CACHE_LIFETIME = 10_s;
+  static constexpr size_t REPLY_CACHE_CAPACITY = 4096;
+
+  explicit PrefixAllocate(Face& face, KeyChain& keyChain, Scheduler& sched, const Options& opts)
+    : m_face(face)
+    , m_signer(keyChain)
+    , m_controller(face, keyChain)
+    , m_sched(sched)
+    , m_faceMonitor(face)
+    , m_opts(opts) {
+    m_opts.maxLeasesPerFace = std::max<size_t>(m_opts.maxLeasesPerFace, 1);
+    if (!m_opts.stateFile.empty()) {
+      m_log.emplace(m_opts.stateFile);
+    }
+  }
+
+  bool needsLocalFields() const override {
+    return true;
+  }
+
+  void start() override {
+    m_faceMonitor.onNotification.connect([this](const nfd::FaceEventNotification& n) {
+      if (n.getKind() == nfd::FACE_EVENT_DESTROYED && m_faces.erase(n.getFaceId()) > 0 &&
+          m_log) {
+        m_log->removeFace(n.getFaceId());
+      }
+      m_nLeases.set(countLeases());
+    });
+    m_faceMonitor.start();
+    if (m_opts.leaseDuration > 0_s) {
+      scheduleSweep();
+    }
+
+    if (m_log) {
+      reconcile();
+    } else {
+      listen();
+    }
+  }
+
+private:
+  void listen() {
+    m_face.setInterestFilter("/localhop/prefix-allocate",
+                             std::bind(&PrefixAllocate::processCommand, this, _2),
+                             abortOnRegisterFail);
+  }
+
+  // Restore leases from state file, and compare them with routes in the RIB.
+  // A lease is kept if its route still exists. A route with our origin but no lease is removed.
+  void reconcile(time::seconds retryDelay = 1_s) {
+    LeaseTable saved = m_log->load();
+    m_controller.fetch<nfd::RibDataset>(
+      [this, saved = std::move(saved)](const std::vector<nfd::RibEntry>& dataset) mutable {
+        auto now = time::system_clock::now();
+        for (const auto& entry : dataset) {
+          for (const auto& route : entry.getRoutes()) {
+            if (route.getOrigin() != ORIGIN_ALLOCATE) {
+              continue;
+            }
+            auto& leases = saved[route.getFaceId()].leases;
+            auto it = std::find_if(leases.begin(), leases.end(), [&](const Lease& lease) {
+              return lease.prefix == entry.getName();
+            });
+            if (it == leases.end()) {
+              m_orphans.emplace_back(route.getFaceId(), entry.getName());
+              continue;
+            }
+            auto expiry = route.getExpirationPeriod();
+            m_faces[route.getFaceId()].leases.push_back(
+              Lease{it->prefix, expiry ? now + *expiry : time::system_clock::time_point::max()});
+          }
+        }
+        finishReconcile();
+      },
+      [this, retryDelay](uint32_t code, const std::string& reason) {
+        // without RIB information, saved leases cannot be verified; leave the state file
+        // untouched and retry, because NFD may not be ready yet
+        std::cerr << "RibDataset error " << code << " " << reason << ", retry in "
+                  << retryDelay.count() << "s" << std::endl;
+        m_reconcileTimer = m_sched.schedule(retryDelay, [this, retryDelay] {
+          reconcile(std::min(retryDelay * 2, RECONCILE_MAX_RETRY_DELAY));
+        });
+      });
+  }
+
+  void finishReconcile() {
+    std::cerr << "Reconcile leases=" << countLeases() << " orphans=" << m_orphans.size()
+              << std::endl;
+    m_nLeases.set(countLeases());
+    m_log->rewrite(m_faces);
+    for (size_t i = 0; i < RECONCILE_WINDOW; ++i) {
+      unregisterOrphan();
+    }
+    listen();
+  }
+
+  void unregisterOrphan() {
+    if (m_orphans.empty()) {
+      return;
+    }
+    auto [faceId, prefix] = std::move(m_orphans.front());
+    m_orphans.pop_front();
+
+    nfd::ControlParameters p;
+    p.setName(prefix);
+    p.setFaceId(faceId);
+    p.setOrigin(static_cast<nfd::RouteOrigin>(ORIGIN_ALLOCATE));
+    m_controller.start<nfd::RibUnregisterCommand>(
+      p, [this](const auto&) { unregisterOrphan(); },
+      [this, p](const nfd::ControlResponse& resp) {
+        std::cerr << "Unregister " << p.getFaceId() << " " << p.getName() << " error "
+                  << resp.getCode() << std::endl;
+        unregisterOrphan();
+      });
+  }
+
+  void processCommand(const Interest& interest) {
+    auto incomingFaceIdTag = interest.getTag<lp::IncomingFaceIdTag>();
+    if (incomingFaceIdTag == nullptr) {
+      return;
+    }
+    uint64_t faceId = *incomingFaceIdTag;
+
+    // retransmission: answer from reply cache, or drop if the original is still being processed
+    auto cached = m_replyCache.find({faceId, interest.getName()});
+    if (cached != m_replyCache.end()) {
+      m_nReplyCacheHits.inc();
+      if (cached->second != nullptr) {
+        m_face.put(*cached->second);
+      }
+      return;
+    }
+
+    auto now = time::system_clock::now();
+    FaceLeases& fl = m_faces[faceId];
+    removeExpired(fl, now);
+
+    // another request from this face would exceed the limit once in-flight registrations
+    // complete: wait for the newest one
+    if (!fl.inFlight.empty() && fl.leases.size() + fl.inFlight.size() >= m_opts.maxLeasesPerFace) {
+      // allocated prefixes of a face sort by timestamp, so the last one is the newest
+      addPending(faceId, interest, fl.inFlight.rbegin()->second);
+      return;
+    }
+
+    // reuse newest lease when the face has reached its limit
+    if (fl.leases.size() >= m_opts.maxLeasesPerFace) {
+      const Lease& lease = fl.leases.back();
+      m_nLeasesReused.inc();
+      if (needsRenewal(lease, now)) {
+        registerPrefix(faceId, lease.prefix, interest);
+      } else {
+        reply(faceId, interest, lease.prefix);
+      }
+      return;
+    }
+
+    // timestamp is unique per face, so that the allocated prefix is unique
+    int timestamp = std::max(static_cast<int>(::time(nullptr)), fl.lastTimestamp + 1);
+    fl.lastTimestamp = timestamp;
+    char suffix[30];
+    snprintf(suffix, sizeof(suffix), "%d_%d", timestamp, static_cast<int>(faceId));
+    Name prefix(m_opts.prefix);
+    prefix.append(suffix);
+    m_nAllocations.inc();
+    registerPrefix(faceId, prefix, interest);
+  }
+
+  // Register or renew a prefix toward a face.
+  // Interests for a prefix whose registration is in flight are answered when it completes.
+  void registerPrefix(uint64_t faceId, const Name& prefix, const Interest& interest) {
+    auto [it, isNew] = m_faces[faceId].inFlight.try_emplace(prefix);
+    addPending(faceId, interest, it->second);
+    if (!isNew) {
+      return;
+    }
+
+    nfd::ControlParameters p;
+    p.setName(prefix);
+    p.setFaceId(faceId);
+    p.setOrigin(static_cast<nfd::RouteOrigin>(ORIGIN_ALLOCATE));
+    p.setCost(800);
+    if (m_opts.leaseDuration > 0_s) {
+      p.setExpirationPeriod(m_opts.leaseDuration);
+    }
+    m_controller.start<nfd::RibRegisterCommand>(
+      p, bind(&PrefixAllocate::onRegisterSucceed, this, _1),
+      bind(&PrefixAllocate::onRegisterFail, this, p, _1));
+  }
+
+  void addPending(uint64_t faceId, const Interest& interest, std::vector<Interest>& pending) {
+    pending.push_back(interest);
+    insertReplyCache(faceId, interest.getName(), nullptr);
+  }
+
+  // Detach Interests awaiting registration of a prefix.
+  std::vector<Interest> takePending(uint64_t faceId, const Name& prefix) {
+    std::vector<Interest> pending;
+    auto faceIt = m_faces.find(faceId);
+    if (faceIt == m_faces.end()) {
+      return pending;
+    }
+    auto it = faceIt->second.inFlight.find(prefix);
+    if (it != faceIt->second.inFlight.end()) {
+      pending = std::move(it->second);
+      faceIt->second.inFlight.erase(it);
+    }
+    return pending;
+  }
+
+  void onRegisterSucceed(const nfd::ControlParameters& p) {
+    std::cout << ::time(nullptr) << '\t' << 0 << '\t' << p.getFaceId() << '\t' << p.getName()
+              << std::endl;
+
+    auto pending = takePending(p.getFaceId(), p.getName());
+    auto faceIt = m_faces.find(p.getFaceId());
+    if (faceIt == m_faces.end()) {
+      return; // face was destroyed
+    }
+
+    auto expiry = m_opts.leaseDuration > 0_s
+                    ? time::system_clock::now() + m_opts.leaseDuration
+                    : time::system_clock::time_point::max();
+    auto& leases = faceIt->second.leases;
+    auto it = std::find_if(leases.begin(), leases.end(),
+                           [&](const Lease& lease) { return lease.prefix == p.getName(); });
+    if (it == leases.end()) {
+      leases.push_back(Lease{p.getName(), expiry});
+      if (m_log) {
+        m_log->add(p.getFaceId(), leases.back());
+      }
+      // concurrent requests may exceed the limit; the oldest route expires or stays until the
+      // face is closed, but is no longer handed out
+      while (leases.size() > m_opts.maxLeasesPerFace) {
+        if (m_log) {
+          m_log->remove(p.getFaceId(), leases.front().prefix);
+        }
+        leases.pop_front();
+      }
+    } else {
+      it->expiry = expiry;
+      if (m_log) {
+        m_log->add(p.getFaceId(), *it);
+      }
+    }
+
+    m_nLeases.set(countLeases());
+
+    for (const auto& interest : pending) {
+      reply(p.getFaceId(), interest, p.getName());
+    }
+  }
+
+  void onRegisterFail(const nfd::ControlParameters& p, const nfd::ControlResponse& resp) {
+    std::cout << ::time(nullptr) << '\t' << resp.getCode() << '\t' << p.getFaceId() << '\t'
+              << p.getName() << std::endl;
+
+    // allow retransmissions to retry
+    for (const auto& interest : takePending(p.getFaceId(), p.getName())) {
+      m_replyCache.erase({p.getFaceId(), interest.getName()});
+    }
+  }
+
+  void reply(uint64_t faceId, const Interest& interest, const Name& prefix) {
+    auto data = std::make_shared<Data>(interest.getName());
+    data->setContent(prefix.wireEncode());
+    m_signer.sign(*data);
+    m_face.put(*data);
+    insertReplyCache(faceId, interest.getName(), std::move(data));
+  }
+
+  // Insert or update a reply cache entry. Null data indicates the request is being processed.
+  // Entries are evicted in insertion order, after REPLY_CACHE_LIFETIME or when over capacity.
+  void insertReplyCache(uint64_t faceId, const Name& name, std::shared_ptr<Data> data) {
+    auto now = time::steady_clock::now();
+    while (!m_replyCacheQueue.empty() &&
+           (m_replyCacheQueue.front().first <= now ||
+            m_replyCacheQueue.size() >= REPLY_CACHE_CAPACITY)) {
+      m_replyCache.erase(m_replyCacheQueue.front().second);
+      m_replyCacheQueue.pop_front();
+    }
+
+    ReplyCacheKey key{faceId, name};
+    auto [it, isNew] = m_replyCache.insert_or_assign(key, std::move(data));
+    if (isNew) {
+      m_replyCacheQueue.emplace_back(now + REPLY_CACHE_LIFETIME, std::move(key));
+    }
+  }
+
+  // A lease is renewed when less than half of its duration remains.
+  bool needsRenewal(const Lease& lease, time::system_clock::time_point now) const {
+    return lease.expiry != time::system_clock::time_point::max() &&
+           lease.expiry - now < m_opts.leaseDuration / 2;
+  }
+
+  static void removeExpired(FaceLeases& fl, time::system_clock::time_point now) {
+    fl.leases.erase(std::remove_if(fl.leases.begin(), fl.leases.end(),
+                                   [now](const Lease& lease) { return lease.expiry <= now; }),
+                    fl.leases.end());
+  }
+
+  // Periodically drop expired leases of faces that stopped asking.
+  void scheduleSweep() {
+    m_sweepTimer = m_sched.schedule(m_opts.leaseDuration, [this] {
+      auto now = time::system_clock::now();
+      for (auto it = m_faces.begin(); it != m_faces.end();) {
+        removeExpired(it->second, now);
+        if (it->second.leases.empty() && it->second.inFlight.empty()) {
+          it = m_faces.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      m_nLeases.set(countLeases());
+      if (m_log && m_log->needsRewrite(countLeases())) {
+        m_log->rewrite(m_faces);
+      }
+      scheduleSweep();
+    });
+  }
+
+  size_t countLeases() const {
+    size_t n = 0;
+    for (const auto& [faceId, fl] : m_faces) {
+      n += fl.leases.size();
+    }
+    return n;
+  }
+
+private:
+  Face& m_face;
+  CachedSigner m_signer;
+  nfd::Controller m_controller;
+  Scheduler& m_sched;
+  nfd::FaceMonitor m_faceMonitor;
+  Options m_opts;
+  LeaseTable m_faces;
+  ndn::scheduler::ScopedEventId m_sweepTimer;
+  ndn::scheduler::ScopedEventId m_reconcileTimer;
+  std::optional<LeaseLog> m_log;
+  std::deque<std::pair<uint64_t, Name>> m_orphans;
+
+  using ReplyCacheKey = std::pair<uint64_t, Name>;
+  std::map<ReplyCacheKey, std::shared_ptr<Data>> m_replyCache;
+  std::deque<std::pair<time::steady_clock::time_point, ReplyCacheKey>> m_replyCacheQueue;
+
+  Metrics::Counter m_nAllocations = Metrics::get().counter("allocations");
+  Metrics::Counter m_nLeasesReused = Metrics::get().counter("leases-reused");
+  Metrics::Counter m_nReplyCacheHits = Metrics::get().counter("reply-cache-hits");
+  Metrics::Gauge m_nLeases = Metrics::get().gauge("leases");
+};
+
+inline PrefixAllocate::Options
+parseOptions(const std::vector<std::string>& args) {
+  PrefixAllocate::Options opts;
+  int leaseDuration = 0;
+  parseProgramOptions(
+    args,
+    "Usage: ndn6-prefix-allocate [options] /prefix\n"
+    "\n"
+    "Allocate a prefix to requesting face.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("prefix", po::value(&opts.prefix)->required(), "allocation prefix");
+      addOption("lease", po::value(&leaseDuration), "lease duration (seconds), 0 means no expiry");
+      addOption("max-leases-per-face",
+                po::value(&opts.maxLeasesPerFace)->default_value(opts.maxLeasesPerFace),
+                "maximum number of prefixes allocated to each face");
+      addOption("state", po::value(&opts.stateFile), "lease state file for warm restart");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    },
+    "prefix", 1);
+  opts.leaseDuration = time::seconds(leaseDuration);
+  return opts;
+}
+
+} // namespace ndn6::prefix_allocate
+
+#endif // NDN6_TOOLS_PREFIX_ALLOCATE_HPP
@@ -0,0 +1,525 @@
+#ifndef NDN6_TOOLS_PREFIX_PROXY_HPP
+#define NDN6_TOOLS_PREFIX_PROXY_HPP
+
+#include "common.hpp"
+#include "name-trie.hpp"
+#include "probes.hpp"
+#include "replay-table.hpp"
+#include <ndn-cxx/mgmt/dispatcher.hpp>
+#include <ndn-cxx/mgmt/nfd/face-monitor.hpp>
+#include <ndn-cxx/security/certificate-fetcher-direct-fetch.hpp>
+#include <ndn-cxx/security/validation-policy-simple-hierarchy.hpp>
+
+#include <boost/asio/signal_set.hpp>
+#include <deque>
+#include <fstream>
+#include <sstream>
+
+namespace ndn6::prefix_proxy {
+
+namespace mgmt = ndn::mgmt;
+namespace security = ndn::security;
+
+class ValidationPolicyPassInterest : public security::ValidationPolicy {
+public:
+  explicit ValidationPolicyPassInterest(std::unique_ptr<security::ValidationPolicy> inner) {
+    setInnerPolicy(std::move(inner));
+  }
+
+protected:
+  void checkPolicy(const Data& data, const std::shared_ptr<security::ValidationState>& state,
+                   const ValidationContinuation& continueValidation) override {
+    getInnerPolicy().checkPolicy(data, state, continueValidation);
+  }
+
+  void checkPolicy(const Interest& interest,
+                   const std::shared_ptr<security::ValidationState>& state,
+                   const ValidationContinuation& continueValidation) override {
+    const auto& si = interest.getSignatureInfo();
+    if (!si) {
+      state->fail(security::ValidationError::INVALID_KEY_LOCATOR);
+      return;
+    }
+
+    Name klName = getKeyLocatorName(*si, *state);
+    continueValidation(std::make_shared<security::CertificateRequest>(klName), state);
+  }
+};
+
+// Signed Interest timestamp checking, equivalent to ValidationPolicyCommandInterest,
+// with per-key records kept in a fixed-size ReplayTable instead of an unbounded container.
+class ValidationPolicyReplayTable : public security::ValidationPolicy {
+public:
+  explicit ValidationPolicyReplayTable(ReplayTable& table,
+                                       std::unique_ptr<security::ValidationPolicy> inner)
+    : m_table(table) {
+    setInnerPolicy(std::move(inner));
+  }
+
+protected:
+  void checkPolicy(const Data& data, const std::shared_ptr<security::ValidationState>& state,
+                   const ValidationContinuation& continueValidation) override {
+    getInnerPolicy().checkPolicy(data, state, continueValidation);
+  }
+
+  void checkPolicy(const Interest& interest,
+                   const std::shared_ptr<security::ValidationState>& state,
+                   const ValidationContinuation& continueValidation) override {
+    const auto& si = interest.getSignatureInfo();
+    if (!si || !si->getTime()) {
+      state->fail({security::ValidationError::POLICY_ERROR, "SignatureTime missing"});
+      return;
+    }
+
+    auto timestamp = *si->getTime();
+    auto now = time::system_clock::now();
+    if (timestamp < now - GRACE_PERIOD || timestamp > now + GRACE_PERIOD) {
+      state->fail({security::ValidationError::POLICY_ERROR, "SignatureTime out of grace period"});
+      return;
+    }
+
+    Name klName = getKeyLocatorName(*si, *state);
+    if (!state->getOutcome()) {
+      return;
+    }
+
+    uint64_t key = std::hash<Name>()(klName);
+    uint64_t ms = time::toUnixTimestamp(timestamp).count();
+    auto last = m_table.find(key);
+    if (last && ms <= *last) {
+      state->fail({security::ValidationError::POLICY_ERROR, "SignatureTime not increasing"});
+      return;
+    }
+
+    auto interestState = std::dynamic_pointer_cast<security::InterestValidationState>(state);
+    interestState->afterSuccess.connect(
+      [this, key, ms](const Interest&) { m_table.insert(key, ms); });
+    getInnerPolicy().checkPolicy(interest, state, continueValidation);
+  }
+
+private:
+  static constexpr time::milliseconds GRACE_PERIOD = 2_min;
+
+  ReplayTable& m_table;
+};
+
+// Pipeline of RIB commands toward NFD.
+// Commands for the same route (FaceId, Origin, Name) are executed in arrival order, one at a time.
+// An identical command is coalesced with the last pending command of its route, the number of
+// outstanding commands is limited, and re-registration of a route already installed by this proxy
+// is answered locally when the route has no pending command.
+class CommandPipeline : boost::noncopyable {
+public:
+  explicit CommandPipeline(nfd::Controller& controller)
+    : m_controller(controller) {}
+
+  void setMaxOutstanding(size_t n) {
+    m_maxOutstanding = std::max<size_t>(n, 1);
+  }
+
+  template<typename Command>
+  void submit(char verb, const nfd::ControlParameters& params,
+              const mgmt::CommandContinuation& done) {
+    auto routeKey = makeRouteKey(params);
+    auto routeIt = m_routes.find(routeKey);
+    if (routeIt == m_routes.end() && verb == 'R') {
+      auto installed = findInstalled(params);
+      if (installed != nullptr) {
+        nfd::ControlResponse res(200, "");
+        res.setBody(installed->wireEncode());
+        done(res);
+        return;
+      }
+    }
+
+    auto wire = params.wireEncode();
+    std::string key(1, verb);
+    key.append(reinterpret_cast<const char*>(wire.data()), wire.size());
+    if (routeIt != m_routes.end()) {
+      auto& last = m_commands.at(routeIt->second.back());
+      if (last.key == key) {
+        last.waiters.push_back(done);
+        return;
+      }
+    }
+
+    uint64_t id = ++m_lastId;
+    auto& entry = m_commands[id];
+    entry.key = std::move(key);
+    entry.waiters.push_back(done);
+    entry.start = [this, id, verb, params] {
+      m_controller.start<Command>(
+        params,
+        [=](const nfd::ControlParameters& body) {
+          updateInstalled(verb, params, body);
+          nfd::ControlResponse res(200, "");
+          res.setBody(body.wireEncode());
+          finish(id, res);
+        },
+        [=](const nfd::ControlResponse& res) { finish(id, res); });
+    };
+    entry.routeKey = routeKey;
+
+    // a command becomes ready when all earlier commands of its route have finished
+    auto& route = m_routes[routeKey];
+    route.push_back(id);
+    if (route.size() == 1) {
+      m_queue.push_back(id);
+    }
+    startNext();
+  }
+
+  // Forget routes on a destroyed face, which NFD has removed from the RIB.
+  void removeFace(uint64_t faceId) {
+    m_installed.erase(m_installed.lower_bound({faceId, 0, Name()}),
+                      m_installed.lower_bound({faceId + 1, 0, Name()}));
+  }
+
+private:
+  using RouteKey = std::tuple<uint64_t, uint64_t, Name>; // FaceId, Origin, Name
+
+  static RouteKey makeRouteKey(const nfd::ControlParameters& params) {
+    return {params.getFaceId(), params.hasOrigin() ? params.getOrigin() : nfd::ROUTE_ORIGIN_APP,
+            params.getName()};
+  }
+
+  const nfd::ControlParameters* findInstalled(const nfd::ControlParameters& params) const {
+    if (params.hasExpirationPeriod()) {
+      return nullptr;
+    }
+    auto it = m_installed.find(makeRouteKey(params));
+    if (it == m_installed.end()) {
+      return nullptr;
+    }
+    const auto& installed = it->second;
+    uint64_t cost = params.hasCost() ? params.getCost() : 0;
+    uint64_t flags = params.hasFlags() ? params.getFlags() : nfd::ROUTE_FLAG_CHILD_INHERIT;
+    if (installed.hasExpirationPeriod() || installed.getCost() != cost ||
+        installed.getFlags() != flags) {
+      return nullptr;
+    }
+    return &installed;
+  }
+
+  void updateInstalled(char verb, const nfd::ControlParameters& params,
+                       const nfd::ControlParameters& body) {
+    if (verb == 'R') {
+      m_installed.insert_or_assign(makeRouteKey(body), body);
+    } else {
+      m_installed.erase(makeRouteKey(params));
+    }
+  }
+
+  void startNext() {
+    while (m_nOutstanding < m_maxOutstanding && !m_queue.empty()) {
+      auto it = m_commands.find(m_queue.front());
+      m_queue.pop_front();
+      ++m_nOutstanding;
+      it->second.start();
+    }
+  }
+
+  void finish(uint64_t id, const nfd::ControlResponse& res) {
+    auto it = m_commands.find(id);
+    auto waiters = std::move(it->second.waiters);
+    auto routeIt = m_routes.find(it->second.routeKey);
+    m_commands.erase(it);
+    --m_nOutstanding;
+
+    routeIt->second.pop_front();
+    if (routeIt->second.empty()) {
+      m_routes.erase(routeIt);
+    } else {
+      m_queue.push_back(routeIt->second.front());
+    }
+
+    for (const auto& done : waiters) {
+      done(res);
+    }
+    startNext();
+  }
+
+private:
+  struct Entry {
+    std::string key; // verb and ControlParameters wire, for coalescing
+    RouteKey routeKey;
+    std::function<void()> start;
+    std::vector<mgmt::CommandContinuation> waiters;
+  };
+
+  nfd::Controller& m_controller;
+  size_t m_maxOutstanding = 16;
+  size_t m_nOutstanding = 0;
+  uint64_t m_lastId = 0;
+  std::map<uint64_t, Entry> m_commands;
+  std::map<RouteKey, std::deque<uint64_t>> m_routes; // pending commands of each route, in order
+  std::deque<uint64_t> m_queue;                       // commands ready to start
+  std::map<RouteKey, nfd::ControlParameters> m_installed;
+};
+
+static const auto nRegistrations = Metrics::get().counter("registrations-proxied");
+static const auto nUnregistrations = Metrics::get().counter("unregistrations-proxied");
+static const auto nRejected = Metrics::get().counter("rejected");
+static const auto commandLatency = Metrics::get().histogram("command-latency");
+
+struct Options {
+  Name listenPrefix = "/localhop/nfd";
+  std::vector<std::pair<std::string, Certificate>> anchors; // filename, certificate
+  std::vector<Name> openPrefixes;
+  std::string delegationFile;
+  size_t maxOutstanding = 16;
+  size_t replayCapacity = 65536;
+  Name metricsPrefix;
+};
+
+// Parse options and load trust anchors. Exits the program if an anchor cannot be loaded.
+inline Options
+parseOptions(const std::vector<std::string>& args) {
+  Options opts;
+  std::vector<std::string> anchorFiles;
+  parseProgramOptions(
+    args,
+    "Usage: ndn6-prefix-proxy\n"
+    "\n"
+    "Proxy prefix registration commands.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("listen", po::value(&opts.listenPrefix), "listen prefix");
+      addOption("anchor", po::value(&anchorFiles)->required()->composing(),
+                "hierarchical trust anchor files");
+      addOption("open-prefix", po::value(&opts.openPrefixes)->composing(),
+                "prefixes anyone can register");
+      addOption("delegation", po::value(&opts.delegationFile),
+                "file of additional prefixes per signer identity, reloaded on SIGHUP");
+      addOption("max-outstanding", po::value(&opts.maxOutstanding)->default_value(16),
+                "maximum outstanding commands to NFD");
+      addOption("replay-capacity", po::value(&opts.replayCapacity)->default_value(65536),
+                "signing keys tracked for replay protection");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    });
+
+  for (const std::string& filename : anchorFiles) {
+    auto cert = io::load<Certificate>(filename);
+    if (cert == nullptr) {
+      std::cerr << "anchor file not found: " << filename << std::endl;
+      std::exit(1);
+    }
+    opts.anchors.emplace_back(filename, std::move(*cert));
+  }
+  return opts;
+}
+
+class PrefixProxy : public Service {
+public:
+  // Throws if the delegation file cannot be loaded.
+  explicit PrefixProxy(Face& face, KeyChain& keyChain, const Options& opts)
+    : m_face(face)
+    , m_controller(face, keyChain)
+    , m_pipeline(m_controller)
+    , m_faceMonitor(face)
+    , m_replayTable(opts.replayCapacity)
+    , m_validator(std::make_unique<ValidationPolicyReplayTable>(
+                    m_replayTable,
+                    std::make_unique<ValidationPolicyPassInterest>(
+                      std::make_unique<security::ValidationPolicySimpleHierarchy>())),
+                  std::make_unique<security::CertificateFetcherDirectFetch>(face))
+    , m_dispatcher(face, keyChain)
+    , m_opts(opts) {
+    m_pipeline.setMaxOutstanding(m_opts.maxOutstanding);
+    for (const Name& prefix : m_opts.openPrefixes) {
+      m_openPrefixes.insert(prefix);
+    }
+    for (const auto& [filename, cert] : m_opts.anchors) {
+      m_validator.loadAnchor(filename, Certificate(cert));
+    }
+    if (!m_opts.delegationFile.empty() && !loadDelegations()) {
+      throw std::runtime_error("cannot load delegation file");
+    }
+  }
+
+  bool needsLocalFields() const override {
+    return true;
+  }
+
+  void start() override {
+    if (!m_opts.delegationFile.empty()) {
+      m_reloadSignal.emplace(m_face.getIoContext(), SIGHUP);
+      waitReload();
+    }
+
+    const Name& listenPrefix = m_opts.listenPrefix;
+    m_face.registerPrefix(Name(listenPrefix).append(ndn::PartialName("rib/register")), nullptr,
+                          abortOnRegisterFail, SigningInfo(), nfd::ROUTE_FLAG_CAPTURE);
+    m_face.registerPrefix(Name(listenPrefix).append(ndn::PartialName("rib/unregister")), nullptr,
+                          abortOnRegisterFail, SigningInfo(), nfd::ROUTE_FLAG_CAPTURE);
+
+    defineCommand<nfd::RibRegisterCommand>('R');
+    defineCommand<nfd::RibUnregisterCommand>('U');
+    m_dispatcher.addTopPrefix(listenPrefix, false);
+
+    m_faceMonitor.onNotification.connect([this](const nfd::FaceEventNotification& n) {
+      if (n.getKind() == nfd::FACE_EVENT_DESTROYED) {
+        m_pipeline.removeFace(n.getFaceId());
+      }
+    });
+    m_faceMonitor.start();
+  }
+
+private:
+  void waitReload() {
+    m_reloadSignal->async_wait([this](const boost::system::error_code& ec, int) {
+      if (ec) {
+        return;
+      }
+      loadDelegations();
+      waitReload();
+    });
+  }
+
+  bool loadDelegations() {
+    const std::string& delegationFile = m_opts.delegationFile;
+    std::ifstream file(delegationFile);
+    if (!file) {
+      std::cerr << "delegation file not found: " << delegationFile << std::endl;
+      return false;
+    }
+
+    std::map<Name, NameTrie> loaded;
+    size_t nEntries = 0;
+    std::string line;
+    for (int lineNo = 1; std::getline(file, line); ++lineNo) {
+      std::istringstream fields(line);
+      std::string identity, prefix;
+      if (!(fields >> identity) || identity.front() == '#') {
+        continue;
+      }
+      if (!(fields >> prefix)) {
+        std::cerr << delegationFile << ":" << lineNo << ": prefix missing" << std::endl;
+        return false;
+      }
+      try {
+        loaded[Name(identity)].insert(Name(prefix));
+      } catch (const tlv::Error& e) {
+        std::cerr << delegationFile << ":" << lineNo << ": " << e.what() << std::endl;
+        return false;
+      }
+      ++nEntries;
+    }
+
+    m_delegations.swap(loaded);
+    std::cerr << "delegation loaded " << m_delegations.size() << " identities " << nEntries
+              << " prefixes" << std::endl;
+    return true;
+  }
+
+  bool isDelegated(const Name& signer, const Name& name) const {
+    auto it = m_delegations.find(signer);
+    return it != m_delegations.end() && it->second.covers(name);
+  }
+
+  void authorize(const Interest& interest, const mgmt::ControlParametersBase* params0,
+                 const mgmt::AcceptContinuation& accept, const mgmt::RejectContinuation& reject) {
+    NDN6_PROBE(proxy_command, probeHash(interest.getName()), interest.wireEncode().size());
+    const auto& params = static_cast<const nfd::ControlParameters&>(*params0);
+    if (!params.hasName()) {
+      nRejected.inc();
+      reject(mgmt::RejectReply::SILENT);
+      return;
+    }
+
+    std::optional<Name> signer;
+    try {
+      auto si = interest.getSignatureInfo();
+      if (!si) {
+        si.emplace(interest.getName().at(ndn::signed_interest::POS_SIG_INFO).blockFromValue());
+      }
+      if (si->hasKeyLocator() && si->getKeyLocator().getType() == tlv::Name) {
+        signer = security::extractIdentityNameFromKeyLocator(si->getKeyLocator().getName());
+      }
+    } catch (const tlv::Error&) {
+    }
+    if (!signer) {
+      nRejected.inc();
+      reject(mgmt::RejectReply::SILENT);
+      return;
+    }
+
+    auto name = params.getName();
+    if (!(signer->isPrefixOf(name) || m_openPrefixes.covers(name) || isDelegated(*signer, name))) {
+      std::cout << "!\t\t" << name << "\tprefix-disallowed\t" << *signer << std::endl;
+      nRejected.inc();
+      reject(mgmt::RejectReply::STATUS403);
+      return;
+    }
+
+    m_validator.validate(
+      interest,
+      [=](const Interest& validated) {
+        NDN6_PROBE(proxy_validated, probeHash(validated.getName()), validated.wireEncode().size());
+        accept("");
+      },
+      [=](const Interest&, const security::ValidationError& e) {
+        std::cout << "!\t\t" << name << "\tvalidator-" << e.getCode() << "\t" << *signer
+                  << std::endl;
+        nRejected.inc();
+        reject(mgmt::RejectReply::STATUS403);
+      });
+  }
+
+  template<typename Command>
+  void defineCommand(char verb) {
+    m_dispatcher.addControlCommand<Command>(
+      [this](const Name&, const Interest& interest, const mgmt::ControlParametersBase* params,
+             const mgmt::AcceptContinuation& accept, const mgmt::RejectContinuation& reject) {
+        authorize(interest, params, accept, reject);
+      },
+      [this, verb](const Name&, const Interest& interest,
+                   const mgmt::ControlParametersBase& params,
+                   const mgmt::CommandContinuation& done) {
+        auto incomingFaceIdTag = interest.getTag<lp::IncomingFaceIdTag>();
+        if (incomingFaceIdTag == nullptr) {
+          done(nfd::ControlResponse(400, "IncomingFaceId missing"));
+          return;
+        }
+        uint64_t nameHash = NDN6_PROBE_ENABLED(proxy_response) || NDN6_PROBE_ENABLED(proxy_put)
+                              ? probeHash(interest.getName())
+                              : 0;
+        proxyCommand<Command>(verb, *incomingFaceIdTag,
+                              static_cast<const nfd::ControlParameters&>(params), done, nameHash);
+      });
+  }
+
+  template<typename Command>
+  void proxyCommand(char verb, uint64_t client, nfd::ControlParameters params,
+                    mgmt::CommandContinuation done, uint64_t nameHash = 0) {
+    params.setFaceId(client);
+    auto t0 = time::steady_clock::now();
+    m_pipeline.submit<Command>(verb, params, [=](const nfd::ControlResponse& res) {
+      NDN6_PROBE(proxy_response, nameHash, res.getCode());
+      commandLatency.observeSince(t0);
+      (verb == 'R' ? nRegistrations : nUnregistrations).inc();
+      std::cout << verb << '\t' << client << '\t' << params.getName() << '\t' << res.getCode()
+                << std::endl;
+      done(res);
+      NDN6_PROBE(proxy_put, nameHash, res.getCode());
+    });
+  }
+
+private:
+  Face& m_face;
+  nfd::Controller m_controller;
+  CommandPipeline m_pipeline;
+  nfd::FaceMonitor m_faceMonitor;
+  ReplayTable m_replayTable;
+  security::Validator m_validator;
+  mgmt::Dispatcher m_dispatcher;
+  Options m_opts;
+  NameTrie m_openPrefixes;
+  std::map<Name, NameTrie> m_delegations;
+  std::optional<boost::asio::signal_set> m_reloadSignal;
+};
+
+} // namespace ndn6::prefix_proxy
+
+#endif // NDN6_TOOLS_PREFIX_PROXY_HPP
@@ -0,0 +1,66 @@
+#ifndef NDN6_TOOLS_PROBES_HPP
+#define NDN6_TOOLS_PROBES_HPP
+
+#include "common.hpp"
+
+// USDT probes, compiled in when <sys/sdt.h> is available (systemtap-sdt-dev package), unless
+// NDN6_NO_USDT is defined. Every probe has arguments (name hash, size). Each probe has a
+// semaphore that the tracer increments upon attaching, so that arguments are computed only while
+// the probe is being traced. See bpftrace/ directory for scripts using these probes.
+#if !defined(NDN6_NO_USDT) && __has_include(<sys/sdt.h>)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+// Semaphores are defined in this header, because each program is a single translation unit.
+#define NDN6_PROBE_SEMAPHORE(probe)                                                                \
+  extern "C" {                                                                                     \
+  __extension__ volatile unsigned short ndn6_##probe##_semaphore                                   \
+    __attribute__((unused, section(".probes")));                                                   \
+  }
+
+#define NDN6_PROBE_ENABLED(probe) (__builtin_expect(ndn6_##probe##_semaphore != 0, 0))
+
+#define NDN6_PROBE(probe, hash, size)                                                              \
+  do {                                                                                             \
+    if (NDN6_PROBE_ENABLED(probe)) {                                                               \
+      STAP_PROBE2(ndn6, probe, static_cast<uint64_t>(hash), static_cast<uint64_t>(size));          \
+    }                                                                                              \
+  } while (false)
+
+#else
+#define NDN6_PROBE_SEMAPHORE(probe)
+#define NDN6_PROBE_ENABLED(probe) (false)
+#define NDN6_PROBE(probe, hash, size)                                                              \
+  do {                                                                                             \
+  } while (false)
+#endif
+
+// file-server segment reply: Interest arrival, after file read, after signing, after put.
+// A reply from the segment cache has fs_interest and fs_put only.
+NDN6_PROBE_SEMAPHORE(fs_interest)
+NDN6_PROBE_SEMAPHORE(fs_read)
+NDN6_PROBE_SEMAPHORE(fs_sign)
+NDN6_PROBE_SEMAPHORE(fs_put)
+
+// prefix-proxy command: arrival, after validation, after NFD response, after reply.
+// proxy_response and proxy_put carry the response status code in place of size.
+NDN6_PROBE_SEMAPHORE(proxy_command)
+NDN6_PROBE_SEMAPHORE(proxy_validated)
+NDN6_PROBE_SEMAPHORE(proxy_response)
+NDN6_PROBE_SEMAPHORE(proxy_put)
+
+// serve-certs: Interest arrival, after put of certificate or Nack.
+NDN6_PROBE_SEMAPHORE(certs_interest)
+NDN6_PROBE_SEMAPHORE(certs_put)
+
+namespace ndn6 {
+
+// Name hash that correlates probes of the same request.
+inline uint64_t
+probeHash(const Name& name) {
+  return std::hash<Name>{}(name);
+}
+
+} // namespace ndn6
+
+#endif // NDN6_TOOLS_PROBES_HPP
@@ -1,9 +1,153 @@
 #include "common.hpp"
 
+#include <ndn-cxx/util/random.hpp>
 #include <ndn-cxx/util/time-unit-test-clock.hpp>
 
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
 namespace ndn6::register_prefix_cmd {
 
+static Interest
+makeCommand(const Name& commandPrefix, const nfd::ControlParameters& params, bool isUnregister) {
+  if (isUnregister) {
+    return nfd::RibUnregisterCommand::createRequest(commandPrefix, params);
+  }
+  return nfd::RibRegisterCommand::createRequest(commandPrefix, params);
+}
+
+// Parse a batch line: prefix [face [origin [flags [verb]]]].
+// face "-" means self. verb is "register" or "unregister".
+static std::optional<Interest>
+parseBatchLine(const std::string& line, const Name& commandPrefix) {
+  std::istringstream is(line);
+  std::string prefix, face = "-", verb = "register";
+  int origin = 0;
+  uint64_t flags = nfd::ROUTE_FLAG_CHILD_INHERIT;
+  uint64_t flagsField = 0;
+  is >> prefix;
+  if (is >> face && is >> origin && is >> flagsField) {
+    flags = flagsField;
+    is >> verb;
+  }
+  if (is.fail() && !is.eof()) {
+    return std::nullopt;
+  }
+
+  nfd::ControlParameters params;
+  try {
+    params.setName(Name(prefix));
+  } catch (const tlv::Error&) {
+    return std::nullopt;
+  }
+  if (face != "-") {
+    try {
+      params.setFaceId(std::stoull(face));
+    } catch (const std::exception&) {
+      return std::nullopt;
+    }
+  }
+  params.setOrigin(static_cast<nfd::RouteOrigin>(origin));
+  if (verb == "unregister") {
+    return makeCommand(commandPrefix, params, true);
+  }
+  if (verb != "register") {
+    return std::nullopt;
+  }
+  params.setFlags(flags);
+  return makeCommand(commandPrefix, params, false);
+}
+
+// Sign commands read from a file, and write them to stdout in input order.
+// SignatureInfo of each command is prepared in input order, with increasing timestamps and
+// random nonces, in the same way as InterestSigner. Commands are then signed in parallel, each
+// thread using its own KeyChain instance because KeyChain is not thread-safe. Each thread
+// resolves the signing key once, instead of looking it up in the PIB for every command.
+static int
+runBatch(const std::string& filename, const Name& commandPrefix, const SigningInfo& si,
+         int advanceClock, unsigned nThreads) {
+  std::ifstream file;
+  if (filename != "-") {
+    file.open(filename);
+    if (!file) {
+      std::cerr << "cannot open " << filename << std::endl;
+      return 1;
+    }
+  }
+  std::istream& input = filename == "-" ? std::cin : file;
+
+  struct Command {
+    Interest interest;
+    ndn::SignatureInfo sigInfo;
+    Block wire;
+    std::string error;
+  };
+  std::vector<Command> commands;
+
+  auto timestamp = time::system_clock::now() + time::milliseconds(advanceClock);
+  std::string line;
+  for (int lineNo = 1; std::getline(input, line); ++lineNo) {
+    auto pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos || line[pos] == '#') {
+      continue;
+    }
+    auto interest = parseBatchLine(line, commandPrefix);
+    if (!interest) {
+      std::cerr << "line " << lineNo << ": invalid record" << std::endl;
+      return 1;
+    }
+
+    ndn::SignatureInfo sigInfo;
+    sigInfo.setTime(timestamp);
+    std::vector<uint8_t> nonce(8);
+    ndn::random::generateSecureBytes(nonce);
+    sigInfo.setNonce(nonce);
+    timestamp += 1_ms;
+    commands.push_back(Command{std::move(*interest), std::move(sigInfo), Block(), ""});
+  }
+
+  std::atomic<size_t> next{0};
+  auto work = [&](KeyChain& keyChain) {
+    SigningInfo cmdSi = resolveSigningKey(keyChain, si);
+    cmdSi.setSignedInterestFormat(ndn::security::SignedInterestFormat::V03);
+    for (size_t i = next++; i < commands.size(); i = next++) {
+      auto& cmd = commands[i];
+      try {
+        cmdSi.setSignatureInfo(cmd.sigInfo);
+        keyChain.sign(cmd.interest, cmdSi);
+        cmd.wire = cmd.interest.wireEncode();
+      } catch (const std::exception& e) {
+        cmd.error = e.what();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < std::min<size_t>(nThreads, commands.size()); ++i) {
+    threads.emplace_back([&] {
+      KeyChain keyChain;
+      work(keyChain);
+    });
+  }
+  work(getKeyChain());
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  StartupTimer::mark("signed");
+
+  for (const auto& cmd : commands) {
+    if (!cmd.error.empty()) {
+      std::cerr << cmd.interest.getName() << ": " << cmd.error << std::endl;
+      return 1;
+    }
+  }
+  for (const auto& cmd : commands) {
+    std::cout.write(reinterpret_cast<const char*>(cmd.wire.data()), cmd.wire.size());
+  }
+  return 0;
+}
+
 int
 main(int argc, char** argv) {
   Name prefix;
@@ -12,28 +156,46 @@ main(int argc, char** argv) {
   int origin = 0;
   SigningInfo si;
   int advanceClock = 0;
+  std::string batch;
+  unsigned nThreads = std::max(1U, std::thread::hardware_concurrency());
 
   auto args = parseProgramOptions(
     argc, argv,
     "Usage: ndn6-register-prefix-cmd [-u] -p /laptop-prefix -f 256 -i /identity\n"
+    "       ndn6-register-prefix-cmd --batch records.txt -i /identity\n"
     "\n"
     "Prepare a prefix (un)registration command.\n"
     "\n",
     [&](auto addOption) {
       addOption("unregister,u", "unregister");
-      addOption("prefix,p", po::value<Name>(&prefix)->required(), "prefix");
+      addOption("prefix,p", po::value<Name>(&prefix), "prefix");
       addOption("command,P", po::value<Name>(&commandPrefix), "command prefix");
       addOption("face,f", po::value<int>(&faceId), "FaceId, default is self");
       addOption("origin,o", po::value<int>(&origin), "origin");
       addOption("no-inherit,I", "unset ChildInherit flag");
       addOption("capture,C", "set Capture flag");
       addOption("identity,i", po::value<Name>(), "signing identity");
-      addOption("advance-clock", po::value<int>(&advanceClock), "advance clock (millis)");
+      addOption("advance-clock", po::value<int>(&advanceClock)->notifier([](int v) {
+        if (v < 0) {
+          throw std::range_error("advance-clock must not be negative");
+        }
+      }),
+                "advance clock (millis)");
+      addOption("batch", po::value(&batch), "read records from file, '-' for stdin");
+      addOption("threads", po::value(&nThreads), "signing threads in batch mode");
     });
 
   if (args.count("identity") > 0) {
     si = signingByIdentity(args["identity"].as<Name>());
   }
+  if (!batch.empty()) {
+    return runBatch(batch, commandPrefix, si, advanceClock, nThreads);
+  }
+  if (args.count("prefix") == 0) {
+    std::cerr << "--prefix or --batch is required" << std::endl;
+    return 2;
+  }
+
   if (advanceClock > 0) {
     auto now = time::system_clock::now();
     auto clock = std::make_shared<time::UnitTestSystemClock>();
@@ -47,18 +209,16 @@ main(int argc, char** argv) {
     params.setFaceId(faceId);
   }
   params.setOrigin(static_cast<nfd::RouteOrigin>(origin));
-  Interest interest;
-  if (args.count("unregister") > 0) {
-    interest = nfd::RibUnregisterCommand::createRequest(commandPrefix, params);
-  } else {
+  bool isUnregister = args.count("unregister") > 0;
+  if (!isUnregister) {
     params.setFlags((args.count("no-inherit") > 0 ? 0 : nfd::ROUTE_FLAG_CHILD_INHERIT) |
                     (args.count("capture") > 0 ? nfd::ROUTE_FLAG_CAPTURE : 0));
-    interest = nfd::RibRegisterCommand::createRequest(commandPrefix, params);
   }
+  Interest interest = makeCommand(commandPrefix, params, isUnregister);
 
-  KeyChain keyChain;
-  InterestSigner cis(keyChain);
+  InterestSigner cis(getKeyChain());
   cis.makeSignedInterest(interest, si);
+  StartupTimer::mark("signed");
 
   Block wire = interest.wireEncode();
   std::cout.write(reinterpret_cast<const char*>(wire.data()), wire.size());
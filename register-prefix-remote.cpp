@@ -1,24 +1,28 @@
 #include "common.hpp"
+#include "lsdb-diff.hpp"
+#include "name-trie.hpp"
 
+#include <boost/asio/signal_set.hpp>
+#include <boost/property_tree/info_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 #include <queue>
+#include <sstream>
 
 namespace ndn6::register_prefix_remote {
 
-static Face face;
-static Scheduler sched(face.getIoContext());
-static KeyChain keyChain;
-static nfd::Controller controller(face, keyChain);
-static InterestSigner cis(keyChain);
-static SigningInfo si;
+namespace pt = boost::property_tree;
 
-static std::string faceUri;
-static std::shared_ptr<ndn::lp::NextHopFaceIdTag> nexthopTag;
-
-static std::optional<time::milliseconds> regExpiration;
-static bool toLocal = false;
+// Face and KeyChain are created in main() after option parsing, so that --help and option
+// errors do not open the PIB and TPM or connect to NFD.
+struct Runtime {
+  KeyChain& keyChain = getKeyChain();
+  Face face{nullptr, keyChain};
+  Scheduler sched{face.getIoContext()};
+  nfd::Controller controller{face, keyChain};
+  InterestSigner cis{keyChain};
+};
+static std::unique_ptr<Runtime> rt;
 static Name nlsrRouter;
-static std::vector<Name> nlsrNamesFilter;
-static std::set<Name> nlsrNames;
 
 class LsdbNamesDataset : public nfd::StatusDatasetBase {
 public:
@@ -27,269 +31,606 @@ public:
   LsdbNamesDataset()
     : Base("nlsr/lsdb/names") {}
 
-  using ResultType = std::set<Name>;
+  using ResultType = std::vector<Block>;
 
   ResultType parseResult(ndn::ConstBufferPtr payload) const {
-    std::set<Name> names;
+    std::vector<Block> lsas;
     size_t offset = 0;
     while (offset < payload->size()) {
-      bool isOk = false;
-      Block lsa;
-      std::tie(isOk, lsa) = Block::fromBuffer(payload, offset);
+      auto [isOk, lsa] = Block::fromBuffer(payload, offset);
       if (!isOk) {
         break;
       }
       offset += lsa.size();
-
-      lsa.parse();
-      for (const auto& element : lsa.elements()) {
-        switch (element.type()) {
-          case tlv::Name:
-            names.emplace(element);
-            break;
-          case 0x92: { // PrefixInfo
-            element.parse();
-            names.emplace(element.get(tlv::Name));
-            break;
-          }
-        }
-      }
+      lsas.push_back(std::move(lsa));
     }
-    return names;
+    return lsas;
   }
 };
 
-static Name commandPrefix("/localhop/nfd");
+static LsdbDiff lsdbDiff;
+
 static auto ribRegister = nfd::RibRegisterCommand::createRequest;
 static auto ribUnregister = nfd::RibUnregisterCommand::createRequest;
 
+static const time::nanoseconds REFRESH_INTERVAL = 60_s;
+static const time::nanoseconds RETRY_INITIAL = 2_s;
+
+// Retry delay after consecutive failures: 2 seconds, doubling up to 60 seconds.
+static time::nanoseconds
+getRetryDelay(int nFailures) {
+  time::nanoseconds delay = RETRY_INITIAL * (1 << std::min(std::max(nFailures - 1, 0), 5));
+  return std::min(delay, REFRESH_INTERVAL);
+}
+
 enum class CommandKind {
-  SENTINEL,
-  UPDATE_NEXTHOP,
   REGISTER,
   UNDO_AUTOREG,
-  UPDATE_NLSR_DATASET,
   NLSR_SYNC,
 };
 
+static const char*
+toString(CommandKind kind) {
+  switch (kind) {
+    case CommandKind::REGISTER:
+      return "register";
+    case CommandKind::UNDO_AUTOREG:
+      return "undo-autoreg";
+    case CommandKind::NLSR_SYNC:
+      return "nlsr-sync";
+  }
+  return "-";
+}
+
 struct Command {
   CommandKind kind;
   Name prefix;
+  time::steady_clock::time_point due;
+  bool isInFlight = false;
+  bool isAdvertise = false;
+  int nFailures = 0;
+  std::string lastResult = "-";
+  std::optional<time::system_clock::time_point> lastSuccess;
 };
 
-static std::queue<Command> commands;
+// Adaptive pacing of signed commands toward the remote router.
+// The window grows by one per window of responses and halves upon Nack or timeout.
+// Commands are sent at intervals of smoothed RTT divided by window, which backs off toward
+// the historical 2-second interval while the remote router is congested.
+class CommandPacer {
+public:
+  void setMaxWindow(size_t n) {
+    m_maxWindow = std::max<size_t>(n, 1);
+  }
 
-static void
-scheduleNext(bool recur = true);
+  size_t getWindow() const {
+    return static_cast<size_t>(m_cwnd);
+  }
 
-static void
-updateNexthop() {
-  controller.fetch<nfd::FaceQueryDataset>(
-    nfd::FaceQueryFilter().setRemoteUri(faceUri),
-    [](const std::vector<nfd::FaceStatus>& faces) {
-      if (faces.empty()) {
-        std::cerr << "FaceQuery face not found" << std::endl;
-        nexthopTag = nullptr;
-        scheduleNext();
+  time::nanoseconds getInterval() const {
+    auto interval = m_srtt / static_cast<int64_t>(getWindow()) * m_backoff;
+    return std::clamp<time::nanoseconds>(interval, MIN_INTERVAL, MAX_INTERVAL);
+  }
+
+  void onResponse(time::nanoseconds rtt) {
+    m_srtt = (m_srtt * 7 + rtt) / 8;
+    m_cwnd = std::min(m_cwnd + 1.0 / m_cwnd, static_cast<double>(m_maxWindow));
+    m_backoff = 1;
+  }
+
+  void onCongestion() {
+    m_cwnd = std::max(m_cwnd / 2.0, 1.0);
+    m_backoff = std::min(m_backoff * 2, MAX_BACKOFF);
+  }
+
+private:
+  static constexpr time::nanoseconds MIN_INTERVAL = 10_ms;
+  static constexpr time::nanoseconds MAX_INTERVAL = 2_s;
+  static constexpr int MAX_BACKOFF = 64;
+
+  size_t m_maxWindow = 8;
+  double m_cwnd = 1.0;
+  time::nanoseconds m_srtt = 1_s;
+  int m_backoff = 1;
+};
+
+enum class CommandOutcome {
+  RESPONSE,
+  CONGESTION,
+};
+
+struct RemoteConfig {
+  std::string faceUri;
+  std::vector<Name> prefixes;
+  std::vector<Name> undoAutoreg;
+  std::vector<Name> nlsrNamesFilter;
+  bool toLocal = false;
+  std::optional<time::milliseconds> regExpiration;
+  SigningInfo si;
+  size_t window = 8;
+};
+
+// Registrations toward one remote router.
+class Remote : boost::noncopyable {
+public:
+  explicit Remote(RemoteConfig cfg, bool wantLogPrefix)
+    : m_cfg(std::move(cfg))
+    , m_commandPrefix(m_cfg.toLocal ? "/localhost/nfd" : "/localhop/nfd") {
+    if (wantLogPrefix) {
+      m_logPrefix = m_cfg.faceUri + " ";
+    }
+    m_pacer.setMaxWindow(m_cfg.window);
+    for (const Name& prefix : m_cfg.nlsrNamesFilter) {
+      m_nlsrFilter.insert(prefix);
+    }
+    for (const Name& prefix : m_cfg.undoAutoreg) {
+      addCommand(CommandKind::UNDO_AUTOREG, prefix);
+    }
+    for (const Name& prefix : m_cfg.prefixes) {
+      addCommand(CommandKind::REGISTER, prefix);
+    }
+  }
+
+  const std::string& getFaceUri() const {
+    return m_cfg.faceUri;
+  }
+
+  bool wantNlsrNames() const {
+    return !m_cfg.nlsrNamesFilter.empty();
+  }
+
+  void setNexthop(std::optional<uint64_t> faceId) {
+    if (!faceId) {
+      if (m_nexthopTag != nullptr) {
+        log() << "FaceDataset face not found" << std::endl;
+      }
+      m_nexthopTag = nullptr;
+      return;
+    }
+
+    if (m_nexthopTag == nullptr || *faceId != m_nexthopTag->get()) {
+      log() << "FaceDataset found " << *faceId << std::endl;
+      m_nexthopTag = std::make_shared<lp::NextHopFaceIdTag>(*faceId);
+      dispatch();
+    }
+  }
+
+  // Handle advertisement or withdrawal of an NLSR name.
+  // The command is scheduled immediately, and sent upon next dispatch.
+  void onNlsrName(const Name& name, bool isAdvertise) {
+    if (!m_nlsrFilter.covers(name)) {
+      return;
+    }
+    if (isAdvertise) {
+      log() << "LSDB-names new " << name << std::endl;
+      m_nlsrNames.insert(name);
+    } else {
+      log() << "LSDB-names gone " << name << std::endl;
+      m_nlsrNames.erase(name);
+    }
+    syncNlsrName(name);
+  }
+
+  // Start commands that are due, in order of due time.
+  // Commands run concurrently up to the pacer window, spaced by the pacer interval.
+  void dispatch() {
+    m_dispatchTimer.cancel();
+    while (!m_dueQueue.empty()) {
+      auto [due, id] = m_dueQueue.top();
+      auto it = m_commands.find(id);
+      if (it == m_commands.end() || it->second.due != due || it->second.isInFlight) {
+        m_dueQueue.pop();
+        continue;
+      }
+
+      auto now = time::steady_clock::now();
+      if (due > now) {
+        m_dispatchTimer = rt->sched.schedule(due - now, [this] { dispatch(); });
+        return;
+      }
+      if (m_nInFlight >= m_pacer.getWindow()) {
+        return;
+      }
+      if (m_nexthopTag == nullptr) {
+        m_dueQueue.pop();
+        scheduleCommand(id, now + RETRY_INITIAL);
+        continue;
+      }
+      if (now < m_nextSendTime) {
+        m_dispatchTimer = rt->sched.schedule(m_nextSendTime - now, [this] { dispatch(); });
         return;
       }
 
-      auto faceId = faces.front().getFaceId();
-      if (nexthopTag == nullptr || faceId != nexthopTag->get()) {
-        std::cerr << "FaceQuery found " << faceId << std::endl;
-        nexthopTag = std::make_shared<lp::NextHopFaceIdTag>(faceId);
+      m_dueQueue.pop();
+      it->second.isInFlight = true;
+      ++m_nInFlight;
+      m_nextSendTime = now + m_pacer.getInterval();
+      regUnregPrefix(id, it->second);
+    }
+  }
+
+  void printState() const {
+    auto now = time::steady_clock::now();
+    for (const auto& [id, cmd] : m_commands) {
+      std::cerr << "STATE\t" << m_cfg.faceUri << '\t' << toString(cmd.kind) << '\t'
+                << cmd.prefix << '\t' << (cmd.isInFlight ? "in-flight" : "scheduled") << '\t'
+                << time::duration_cast<time::milliseconds>(cmd.due - now).count() << '\t'
+                << cmd.nFailures << '\t' << cmd.lastResult << '\t';
+      if (cmd.lastSuccess) {
+        std::cerr << time::toUnixTimestamp(*cmd.lastSuccess).count();
+      } else {
+        std::cerr << '-';
       }
-      scheduleNext();
+      std::cerr << std::endl;
+    }
+  }
+
+private:
+  std::ostream& log() const {
+    return std::cerr << m_logPrefix;
+  }
+
+  void scheduleCommand(uint64_t id, time::steady_clock::time_point due) {
+    m_commands.at(id).due = due;
+    m_dueQueue.emplace(due, id);
+  }
+
+  uint64_t addCommand(CommandKind kind, const Name& prefix) {
+    uint64_t id = ++m_lastCommandId;
+    m_commands.emplace(id, Command{kind, prefix});
+    scheduleCommand(id, time::steady_clock::now());
+    return id;
+  }
+
+  // Registrations are refreshed shortly before they expire.
+  // Without expiry, they are refreshed periodically in case the remote router has lost them.
+  time::nanoseconds getRegisterRefreshInterval() const {
+    if (!m_cfg.regExpiration) {
+      return REFRESH_INTERVAL;
+    }
+    auto margin = std::min<time::nanoseconds>(*m_cfg.regExpiration / 4, REFRESH_INTERVAL);
+    return *m_cfg.regExpiration - margin;
+  }
+
+  // Schedule NLSR_SYNC of a name for immediate execution.
+  // If it is in flight, finishCommand will notice the change and reschedule.
+  void syncNlsrName(const Name& name) {
+    auto it = m_nlsrCommands.find(name);
+    if (it == m_nlsrCommands.end()) {
+      m_nlsrCommands.emplace(name, addCommand(CommandKind::NLSR_SYNC, name));
+      return;
+    }
+    if (!m_commands.at(it->second).isInFlight) {
+      scheduleCommand(it->second, time::steady_clock::now());
+    }
+  }
+
+  // Record command result and schedule its next execution.
+  // Failures are retried with exponential backoff; successes are repeated after the refresh
+  // interval, except that a successful NLSR withdrawal deletes the command.
+  void finishCommand(uint64_t id, bool isSuccess, std::string result, CommandOutcome outcome,
+                     time::nanoseconds rtt = 0_ns) {
+    switch (outcome) {
+      case CommandOutcome::RESPONSE:
+        m_pacer.onResponse(rtt);
+        break;
+      case CommandOutcome::CONGESTION:
+        m_pacer.onCongestion();
+        break;
+    }
+    --m_nInFlight;
+
+    auto& cmd = m_commands.at(id);
+    cmd.isInFlight = false;
+    cmd.lastResult = std::move(result);
+    auto now = time::steady_clock::now();
+    if (!isSuccess) {
+      ++cmd.nFailures;
+      scheduleCommand(id, now + getRetryDelay(cmd.nFailures));
+    } else {
+      cmd.nFailures = 0;
+      cmd.lastSuccess = time::system_clock::now();
+      bool wantAdvertise = m_nlsrNames.count(cmd.prefix) > 0;
+      if (cmd.kind != CommandKind::NLSR_SYNC) {
+        scheduleCommand(id, now + (cmd.kind == CommandKind::REGISTER
+                                     ? getRegisterRefreshInterval()
+                                     : REFRESH_INTERVAL));
+      } else if (wantAdvertise != cmd.isAdvertise) {
+        scheduleCommand(id, now);
+      } else if (wantAdvertise) {
+        scheduleCommand(id, now + getRegisterRefreshInterval());
+      } else {
+        m_nlsrCommands.erase(cmd.prefix);
+        m_commands.erase(id);
+      }
+    }
+    dispatch();
+  }
+
+  void regUnregPrefix(uint64_t id, Command& cmd) {
+    const char* verb = nullptr;
+    const decltype(ribRegister)* cc = nullptr;
+    nfd::ControlParameters param;
+    param.setName(cmd.prefix);
+    param.setOrigin(nfd::ROUTE_ORIGIN_CLIENT);
+    if (m_cfg.toLocal) {
+      param.setFaceId(m_nexthopTag->get());
+    }
+    switch (cmd.kind) {
+      case CommandKind::REGISTER:
+        verb = "register";
+        cc = &ribRegister;
+        break;
+      case CommandKind::UNDO_AUTOREG:
+        verb = "undo-autoreg";
+        cc = &ribUnregister;
+        param.setOrigin(nfd::ROUTE_ORIGIN_AUTOREG);
+        break;
+      case CommandKind::NLSR_SYNC:
+        cmd.isAdvertise = m_nlsrNames.count(cmd.prefix) > 0;
+        if (cmd.isAdvertise) {
+          verb = "nlsr-advertise";
+          cc = &ribRegister;
+        } else {
+          verb = "nlsr-withdraw";
+          cc = &ribUnregister;
+        }
+        break;
+    }
+    if (cc == &ribRegister) {
+      param.setFlagBit(nfd::ROUTE_FLAG_CAPTURE, true, false);
+      if (m_cfg.regExpiration) {
+        param.setExpirationPeriod(*m_cfg.regExpiration);
+      }
+    }
+
+    Interest interest((*cc)(m_commandPrefix, param));
+    rt->cis.makeSignedInterest(interest, m_cfg.si);
+    if (!m_cfg.toLocal) {
+      interest.setTag(m_nexthopTag);
+    }
+    auto sendTime = time::steady_clock::now();
+    rt->face.expressInterest(
+      interest,
+      [=](const Interest&, const Data& data) {
+        auto rtt = time::steady_clock::now() - sendTime;
+        try {
+          nfd::ControlResponse response;
+          response.wireDecode(data.getContent().blockFromValue());
+          log() << verb << " " << param.getName() << " " << response.getCode() << std::endl;
+          finishCommand(id, response.getCode() == 200, std::to_string(response.getCode()),
+                        CommandOutcome::RESPONSE, rtt);
+        } catch (const tlv::Error& e) {
+          log() << verb << " " << param.getName() << " bad-response " << e.what() << std::endl;
+          finishCommand(id, false, "bad-response", CommandOutcome::RESPONSE, rtt);
+        }
+      },
+      [=](const Interest&, const lp::Nack& nack) {
+        log() << verb << " " << param.getName() << " Nack~" << nack.getReason() << std::endl;
+        std::ostringstream result;
+        result << "Nack~" << nack.getReason();
+        finishCommand(id, false, result.str(), CommandOutcome::CONGESTION);
+      },
+      [=](const Interest&) {
+        log() << verb << " " << param.getName() << " timeout" << std::endl;
+        finishCommand(id, false, "timeout", CommandOutcome::CONGESTION);
+      });
+  }
+
+private:
+  RemoteConfig m_cfg;
+  Name m_commandPrefix;
+  std::string m_logPrefix;
+  std::shared_ptr<lp::NextHopFaceIdTag> m_nexthopTag;
+  NameTrie m_nlsrFilter;
+  std::set<Name> m_nlsrNames;
+
+  std::map<uint64_t, Command> m_commands;
+  std::map<Name, uint64_t> m_nlsrCommands;
+  uint64_t m_lastCommandId = 0;
+
+  // Commands ordered by due time. Entries are not removed upon rescheduling; an entry is stale
+  // if the command no longer exists, or its due time differs from the entry.
+  using DueEntry = std::pair<time::steady_clock::time_point, uint64_t>;
+  std::priority_queue<DueEntry, std::vector<DueEntry>, std::greater<DueEntry>> m_dueQueue;
+
+  CommandPacer m_pacer;
+  size_t m_nInFlight = 0;
+  time::steady_clock::time_point m_nextSendTime;
+  ndn::scheduler::ScopedEventId m_dispatchTimer;
+};
+
+static std::vector<std::unique_ptr<Remote>> remotes;
+static int nNexthopFailures = 0;
+static int nNlsrFailures = 0;
+static ndn::scheduler::ScopedEventId nexthopTimer;
+static ndn::scheduler::ScopedEventId nlsrTimer;
+
+// Resolve NextHopFaceId of every remote with one FaceDataset fetch.
+static void
+updateNexthops() {
+  rt->controller.fetch<nfd::FaceDataset>(
+    [](const std::vector<nfd::FaceStatus>& dataset) {
+      std::unordered_map<std::string, uint64_t> faceIds;
+      for (const auto& status : dataset) {
+        faceIds.emplace(status.getRemoteUri(), status.getFaceId());
+      }
+
+      bool isComplete = true;
+      for (const auto& remote : remotes) {
+        auto it = faceIds.find(remote->getFaceUri());
+        if (it == faceIds.end()) {
+          isComplete = false;
+          remote->setNexthop(std::nullopt);
+        } else {
+          remote->setNexthop(it->second);
+        }
+      }
+      nNexthopFailures = isComplete ? 0 : nNexthopFailures + 1;
+      nexthopTimer = rt->sched.schedule(
+        isComplete ? REFRESH_INTERVAL : getRetryDelay(nNexthopFailures), updateNexthops);
     },
     [](uint32_t code, const std::string& reason) {
-      std::cerr << "FaceQuery error " << code << " " << reason << std::endl;
-      scheduleNext();
+      std::cerr << "FaceDataset error " << code << " " << reason << std::endl;
+      nexthopTimer = rt->sched.schedule(getRetryDelay(++nNexthopFailures), updateNexthops);
     });
 }
 
+// Fetch NLSR dataset once for all remotes that readvertise NLSR prefixes.
+// Changes are pushed to remotes as advertise and withdraw events.
 static void
 updateNlsrDataset() {
-  controller.fetch<LsdbNamesDataset>(
-    [](const std::set<Name>& dataset) {
-      std::set<Name> acceptNames;
-      for (const auto& name : dataset) {
-        if (std::none_of(nlsrNamesFilter.begin(), nlsrNamesFilter.end(),
-                         [=](const Name& prefix) { return prefix.isPrefixOf(name); })) {
-          continue;
-        }
-        acceptNames.insert(name);
-        if (nlsrNames.count(name) == 0) {
-          std::cerr << "LSDB-names new " << name << std::endl;
-          commands.push({CommandKind::NLSR_SYNC, name});
-        }
+  rt->controller.fetch<LsdbNamesDataset>(
+    [](const std::vector<Block>& dataset) {
+      auto notify = [](bool isAdvertise) {
+        return [isAdvertise](const Name& name) {
+          for (const auto& remote : remotes) {
+            remote->onNlsrName(name, isAdvertise);
+          }
+        };
+      };
+      lsdbDiff.apply(dataset, notify(true), notify(false));
+      for (const auto& remote : remotes) {
+        remote->dispatch();
       }
-      nlsrNames.swap(acceptNames);
-      scheduleNext();
+      nNlsrFailures = 0;
+      nlsrTimer = rt->sched.schedule(REFRESH_INTERVAL, updateNlsrDataset);
     },
     [](uint32_t code, const std::string& reason) {
       std::cerr << "LSDB-names error " << code << " " << reason << std::endl;
-      scheduleNext();
+      nlsrTimer = rt->sched.schedule(getRetryDelay(++nNlsrFailures), updateNlsrDataset);
     },
     nfd::CommandOptions().setPrefix(nlsrRouter));
 }
 
 static void
-regUnregPrefix(const Command& cmd) {
-  if (nexthopTag == nullptr) {
-    scheduleNext();
-    return;
+printState() {
+  std::cerr << "STATE\tremote\tkind\tprefix\tstatus\tdue-ms\tfailures\tlast-result\tlast-success"
+            << std::endl;
+  for (const auto& remote : remotes) {
+    remote->printState();
   }
+}
 
-  bool recur = true;
-  const char* verb = nullptr;
-  const decltype(ribRegister)* cc = nullptr;
-  nfd::ControlParameters param;
-  param.setName(cmd.prefix);
-  param.setOrigin(nfd::ROUTE_ORIGIN_CLIENT);
-  if (toLocal) {
-    param.setFaceId(nexthopTag->get());
-  }
-  switch (cmd.kind) {
-    case CommandKind::REGISTER:
-      verb = "register";
-      cc = &ribRegister;
-      break;
-    case CommandKind::UNDO_AUTOREG:
-      verb = "undo-autoreg";
-      cc = &ribUnregister;
-      param.setOrigin(nfd::ROUTE_ORIGIN_AUTOREG);
-      break;
-    case CommandKind::NLSR_SYNC:
-      if (nlsrNames.count(cmd.prefix) > 0) {
-        verb = "nlsr-advertise";
-        cc = &ribRegister;
-      } else {
-        verb = "nlsr-withdraw";
-        cc = &ribUnregister;
-        recur = false;
-      }
-      break;
-    default:
-      BOOST_ASSERT(false);
-      break;
-  }
-  if (cc == &ribRegister) {
-    param.setFlagBit(nfd::ROUTE_FLAG_CAPTURE, true, false);
-    if (regExpiration) {
-      param.setExpirationPeriod(*regExpiration);
+static std::vector<Name>
+getNames(const pt::ptree& section, const std::string& key) {
+  std::vector<Name> names;
+  for (const auto& [k, v] : section) {
+    if (k == key) {
+      names.emplace_back(v.get_value<std::string>());
     }
   }
-
-  Interest interest((*cc)(commandPrefix, param));
-  cis.makeSignedInterest(interest, si);
-  if (!toLocal) {
-    interest.setTag(nexthopTag);
-  }
-  face.expressInterest(
-    interest,
-    [=](const Interest&, const Data& data) {
-      try {
-        nfd::ControlResponse response;
-        response.wireDecode(data.getContent().blockFromValue());
-        std::cerr << verb << " " << param.getName() << " " << response.getCode() << std::endl;
-      } catch (const tlv::Error& e) {
-        std::cerr << verb << " " << param.getName() << " bad-response " << e.what() << std::endl;
-      }
-      scheduleNext(recur);
-    },
-    [=](const Interest&, const lp::Nack& nack) {
-      std::cerr << verb << " " << param.getName() << " Nack~" << nack.getReason() << std::endl;
-      scheduleNext(recur);
-    },
-    [=](const Interest&) {
-      std::cerr << verb << " " << param.getName() << " timeout" << std::endl;
-      scheduleNext(recur);
-    });
+  return names;
 }
 
 static void
-runFrontCommand() {
-  const auto& cmd = commands.front();
-  switch (cmd.kind) {
-    case CommandKind::SENTINEL:
-      scheduleNext();
-      break;
-    case CommandKind::UPDATE_NEXTHOP:
-      updateNexthop();
-      break;
-    case CommandKind::UPDATE_NLSR_DATASET:
-      updateNlsrDataset();
-      break;
-    case CommandKind::REGISTER:
-    case CommandKind::UNDO_AUTOREG:
-    case CommandKind::NLSR_SYNC:
-      regUnregPrefix(cmd);
-      break;
-  }
-}
+loadConfig(const std::string& filename, const RemoteConfig& defaults) {
+  pt::ptree root;
+  pt::read_info(filename, root);
+  nlsrRouter = root.get<std::string>("nlsr-router", nlsrRouter.toUri());
 
-static void
-scheduleNext(bool recur) {
-  auto cmd = commands.front();
-  commands.pop();
-  auto delay = cmd.kind == CommandKind::SENTINEL ? 60_s : 2_s;
-  if (recur) {
-    commands.push(std::move(cmd));
+  for (const auto& [key, section] : root) {
+    if (key != "remote") {
+      continue;
+    }
+    RemoteConfig cfg = defaults;
+    cfg.faceUri = section.get<std::string>("face");
+    cfg.prefixes = getNames(section, "prefix");
+    cfg.undoAutoreg = getNames(section, "undo-autoreg");
+    cfg.nlsrNamesFilter = getNames(section, "nlsr-readvertise");
+    cfg.toLocal = section.get<bool>("nlsr-to-local", defaults.toLocal);
+    if (auto expiry = section.get_optional<uint32_t>("expiry"); expiry) {
+      if (*expiry == 0) {
+        throw std::range_error("expiry must be positive");
+      }
+      cfg.regExpiration.emplace(1000 * *expiry);
+    }
+    if (auto identity = section.get_optional<std::string>("identity"); identity) {
+      cfg.si = signingByIdentity(Name(*identity));
+    }
+    cfg.window = section.get<size_t>("window", defaults.window);
+    remotes.push_back(std::make_unique<Remote>(std::move(cfg), true));
   }
-
-  sched.schedule(delay, runFrontCommand);
 }
 
 int
 main(int argc, char** argv) {
+  std::string configFile;
+  RemoteConfig cfg;
   auto args = parseProgramOptions(
     argc, argv,
     "Usage: ndn6-register-prefix-remote -f udp4://192.0.2.1:6363 -p /prefix -i /identity\n"
+    "       ndn6-register-prefix-remote -c remotes.conf\n"
     "\n"
-    "Register and keep prefixes on a remote router.\n"
+    "Register and keep prefixes on remote routers.\n"
     "\n",
     [&](auto addOption) {
-      addOption("face,f", po::value<std::string>(&faceUri)->required(), "remote FaceUri");
-      addOption("prefix,p", po::value<std::vector<Name>>()->composing(), "register prefixes");
-      addOption("undo-autoreg", po::value<std::vector<Name>>()->composing(),
+      addOption("face,f", po::value<std::string>(&cfg.faceUri), "remote FaceUri");
+      addOption("config,c", po::value<std::string>(&configFile), "config file of remotes");
+      addOption("prefix,p", po::value<std::vector<Name>>(&cfg.prefixes)->composing(),
+                "register prefixes");
+      addOption("undo-autoreg", po::value<std::vector<Name>>(&cfg.undoAutoreg)->composing(),
                 "unregister autoreg prefixes");
       addOption("nlsr-router", po::value<Name>(&nlsrRouter)->default_value("/localhost"),
                 "NLSR router name");
-      addOption("nlsr-readvertise", po::value<std::vector<Name>>(&nlsrNamesFilter)->composing(),
+      addOption("nlsr-readvertise",
+                po::value<std::vector<Name>>(&cfg.nlsrNamesFilter)->composing(),
                 "readvertise NLSR prefixes");
-      addOption("nlsr-to-local", po::bool_switch(&toLocal), "readvertise to local NLSR instead");
+      addOption("nlsr-to-local", po::bool_switch(&cfg.toLocal),
+                "readvertise to local NLSR instead");
       addOption("identity,i", po::value<Name>(), "signing identity");
-      addOption("expiry", po::value<uint32_t>(), "registration expiration (seconds)");
+      addOption("expiry", po::value<uint32_t>()->notifier([](uint32_t v) {
+        if (v == 0) {
+          throw std::range_error("expiry must be positive");
+        }
+      }),
+                "registration expiration (seconds)");
+      addOption("window", po::value<size_t>(&cfg.window)->default_value(8),
+                "maximum commands in flight to each remote router");
     });
 
-  commands.push({CommandKind::UPDATE_NEXTHOP, ""});
-  if (args.count("undo-autoreg") > 0) {
-    for (const Name& prefix : args["undo-autoreg"].as<std::vector<Name>>()) {
-      commands.push({CommandKind::UNDO_AUTOREG, prefix});
-    }
-  }
-  if (args.count("prefix") > 0) {
-    for (const Name& prefix : args["prefix"].as<std::vector<Name>>()) {
-      commands.push({CommandKind::REGISTER, prefix});
-    }
-  }
-  if (!nlsrNamesFilter.empty()) {
-    commands.push({CommandKind::UPDATE_NLSR_DATASET, ""});
-  }
-  commands.push({CommandKind::SENTINEL, ""});
-
-  if (toLocal) {
-    commandPrefix = "/localhost/nfd";
-  }
   if (args.count("identity") > 0) {
-    si = signingByIdentity(args["identity"].as<Name>());
+    cfg.si = signingByIdentity(args["identity"].as<Name>());
   }
   if (args.count("expiry") > 0) {
-    regExpiration.emplace(1000 * args["expiry"].as<uint32_t>());
+    cfg.regExpiration.emplace(1000 * args["expiry"].as<uint32_t>());
   }
 
-  enableLocalFields(controller, runFrontCommand);
-  face.processEvents();
+  rt = std::make_unique<Runtime>();
+  if (!configFile.empty()) {
+    try {
+      loadConfig(configFile, cfg);
+    } catch (const std::exception& e) {
+      std::cerr << configFile << ": " << e.what() << std::endl;
+      return 2;
+    }
+  } else if (!cfg.faceUri.empty()) {
+    remotes.push_back(std::make_unique<Remote>(std::move(cfg), false));
+  } else {
+    std::cerr << "either --face or --config is required" << std::endl;
+    return 2;
+  }
+
+  boost::asio::signal_set dumpSignal(rt->face.getIoContext(), SIGUSR1);
+  std::function<void()> waitDump = [&] {
+    dumpSignal.async_wait([&](const boost::system::error_code& ec, int) {
+      if (ec) {
+        return;
+      }
+      printState();
+      waitDump();
+    });
+  };
+  waitDump();
+
+  enableLocalFields(rt->controller, [] {
+    updateNexthops();
+    if (std::any_of(remotes.begin(), remotes.end(),
+                    [](const auto& remote) { return remote->wantNlsrNames(); })) {
+      updateNlsrDataset();
+    }
+  });
+  rt->face.processEvents();
   return 0;
 }
 
@@ -0,0 +1,126 @@
+#ifndef NDN6_TOOLS_REPLAY_TABLE_HPP
+#define NDN6_TOOLS_REPLAY_TABLE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ndn6 {
+
+// Fixed-capacity table of last seen command timestamp per signing key.
+// It uses open addressing with a bounded probe window. When every slot in the window is
+// occupied, CLOCK (second chance) eviction picks a victim among them. Each slot is 16 octets.
+class ReplayTable {
+public:
+  static constexpr size_t PROBE_WINDOW = 8;
+
+  explicit ReplayTable(size_t capacity = 0) {
+    reset(capacity);
+  }
+
+  // Discard all records and resize to at least capacity slots.
+  void reset(size_t capacity) {
+    size_t n = PROBE_WINDOW;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    m_slots.assign(n, Slot{});
+    m_mask = n - 1;
+    m_size = 0;
+    m_nEvictions = 0;
+  }
+
+  // Find last timestamp of key hash, and mark the record as recently used.
+  std::optional<uint64_t> find(uint64_t key) {
+    key = normalizeKey(key);
+    size_t home = mix(key);
+    for (size_t i = 0; i < PROBE_WINDOW; ++i) {
+      auto& slot = m_slots[(home + i) & m_mask];
+      if (slot.key == key) {
+        slot.value |= 1;
+        return slot.value >> 1;
+      }
+      if (slot.key == 0) {
+        break;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Insert or update timestamp of key hash. Timestamp must be less than 2^63.
+  void insert(uint64_t key, uint64_t timestamp) {
+    key = normalizeKey(key);
+    size_t home = mix(key);
+    Slot* victim = nullptr;
+    for (size_t i = 0; i < PROBE_WINDOW; ++i) {
+      auto& slot = m_slots[(home + i) & m_mask];
+      if (slot.key == key || slot.key == 0) {
+        m_size += static_cast<size_t>(slot.key == 0);
+        victim = &slot;
+        break;
+      }
+    }
+
+    if (victim == nullptr) {
+      victim = evict(home);
+    }
+    victim->key = key;
+    victim->value = (timestamp << 1) | 1;
+  }
+
+  size_t size() const {
+    return m_size;
+  }
+
+  size_t capacity() const {
+    return m_slots.size();
+  }
+
+  size_t memoryUsage() const {
+    return sizeof(*this) + m_slots.capacity() * sizeof(Slot);
+  }
+
+  uint64_t nEvictions() const {
+    return m_nEvictions;
+  }
+
+private:
+  struct Slot {
+    uint64_t key = 0;   // 0 means empty
+    uint64_t value = 0; // timestamp << 1 | referenced
+  };
+
+  static uint64_t normalizeKey(uint64_t key) {
+    return key == 0 ? 1 : key;
+  }
+
+  // Final mixing step of SplitMix64, in case the key hash has weak low bits.
+  static size_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+    return static_cast<size_t>(x ^ (x >> 31));
+  }
+
+  Slot* evict(size_t home) {
+    ++m_nEvictions;
+    for (size_t i = 0;; i = (i + 1) % PROBE_WINDOW) {
+      auto& slot = m_slots[(home + m_hand + i) & m_mask];
+      if ((slot.value & 1) == 0) {
+        m_hand = (m_hand + i + 1) % PROBE_WINDOW;
+        return &slot;
+      }
+      slot.value &= ~uint64_t(1);
+    }
+  }
+
+private:
+  std::vector<Slot> m_slots;
+  size_t m_mask = 0;
+  size_t m_size = 0;
+  size_t m_hand = 0;
+  uint64_t m_nEvictions = 0;
+};
+
+} // namespace ndn6
+
+#endif // NDN6_TOOLS_REPLAY_TABLE_HPP
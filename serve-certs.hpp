@@ -0,0 +1,239 @@
+#ifndef NDN6_TOOLS_SERVE_CERTS_HPP
+#define NDN6_TOOLS_SERVE_CERTS_HPP
+
+#include "common.hpp"
+#include "probes.hpp"
+
+#include <fstream>
+#include <unordered_set>
+
+namespace ndn6::serve_certs {
+
+const auto FETCH_TIMEOUT = 7777_ms;
+const auto FETCH_RETRY = 7222_ms;
+const size_t BUNDLE_SEGMENT_SIZE = 6144;
+const auto BUNDLE_FRESHNESS = 1_s;
+
+static const name::Component chainComponent(ndn::tlv::KeywordNameComponent,
+                                            {'c', 'h', 'a', 'i', 'n'});
+
+static const auto nCertsServed = Metrics::get().counter("certs-served");
+static const auto nBundleSegmentsServed = Metrics::get().counter("bundle-segments-served");
+static const auto nNacks = Metrics::get().counter("nacks");
+
+struct Options {
+  bool wantIntermediates = false;
+  std::vector<Certificate> certs;
+  Name metricsPrefix;
+};
+
+// Parse options and load certificate files. Exits the program if a file cannot be loaded.
+inline Options
+parseOptions(const std::vector<std::string>& args) {
+  Options opts;
+  std::vector<std::string> certFiles;
+  parseProgramOptions(
+    args, "ndn6-serve-certs cert-file cert-file...\n",
+    [&](auto addOption) {
+      addOption("inter", po::bool_switch(&opts.wantIntermediates),
+                "gather and serve intermediates");
+      addOption("cert-file", po::value(&certFiles)->required()->composing(),
+                "base64 certificate file");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    },
+    "cert-file");
+
+  for (const auto& certFile : certFiles) {
+    try {
+      std::ifstream is(certFile);
+      opts.certs.push_back(io::loadTlv<Certificate>(is));
+    } catch (const io::Error& e) {
+      std::cerr << certFile << ": " << e.what() << std::endl;
+      std::exit(1);
+    }
+  }
+  return opts;
+}
+
+// Certificate chain of a key as a segmented object: concatenated certificate packets, starting
+// from the key's certificate, followed by each issuer certificate that is being served.
+struct Bundle {
+  Name versioned;
+  std::vector<Data> segments;
+};
+
+class ServeCerts : public Service {
+public:
+  explicit ServeCerts(Face& face, KeyChain& keyChain, Scheduler& sched, const Options& opts)
+    : m_face(face)
+    , m_signer(keyChain, ndn::signingWithSha256())
+    , m_sched(sched)
+    , m_opts(opts) {}
+
+  void start() override {
+    for (const auto& cert : m_opts.certs) {
+      add(cert);
+    }
+  }
+
+  void add(const Data& data) {
+    auto keyName = ndn::security::extractKeyNameFromCertName(data.getName());
+    if (m_serving.count(keyName) > 0) {
+      return;
+    }
+
+    std::cout << "<R\t" << keyName << std::endl;
+    m_certs.emplace(keyName, data);
+    // the new certificate may extend the chain of any key
+    m_bundles.clear();
+    m_serving.emplace(keyName, m_face.setInterestFilter(
+                                 keyName,
+                                 [this, keyName](const Name&, const Interest& interest) {
+                                   processInterest(keyName, interest);
+                                 },
+                                 abortOnRegisterFail));
+
+    if (m_opts.wantIntermediates) {
+      gatherIntermediate(data);
+    }
+  }
+
+private:
+  void processInterest(const Name& keyName, const Interest& interest) {
+    NDN6_PROBE(certs_interest, probeHash(interest.getName()), interest.wireEncode().size());
+    std::cout << ">I\t" << interest << std::endl;
+    const Name& name = interest.getName();
+    bool isBundle = name.size() > keyName.size() && name[keyName.size()] == chainComponent;
+    const Data* data = isBundle ? findBundleSegment(keyName, name) : &m_certs.at(keyName);
+    if (data != nullptr && interest.matchesData(*data)) {
+      std::cout << "<D\t" << data->getName() << std::endl;
+      m_face.put(*data);
+      NDN6_PROBE(certs_put, probeHash(interest.getName()), data->wireEncode().size());
+      (isBundle ? nBundleSegmentsServed : nCertsServed).inc();
+    } else {
+      auto nack = Nack(interest).setReason(lp::NackReason::NO_ROUTE);
+      std::cout << "<N\t" << interest << '~' << nack.getReason() << std::endl;
+      m_face.put(nack);
+      NDN6_PROBE(certs_put, probeHash(interest.getName()), 0);
+      nNacks.inc();
+    }
+  }
+
+  // Find bundle segment by Interest name, which is either <key>/32=chain for discovery of the
+  // latest version, or a segment name under the latest version.
+  const Data* findBundleSegment(const Name& keyName, const Name& name) {
+    const Bundle& bundle = getBundle(keyName);
+    if (name.size() == keyName.size() + 1) {
+      return &bundle.segments.front();
+    }
+    if (name.size() == bundle.versioned.size() + 1 && bundle.versioned.isPrefixOf(name) &&
+        name[-1].isSegment() && name[-1].toSegment() < bundle.segments.size()) {
+      return &bundle.segments[name[-1].toSegment()];
+    }
+    return nullptr;
+  }
+
+  // Get the bundle of a key, building it upon first use after a change in served certificates.
+  const Bundle& getBundle(const Name& keyName) {
+    auto [it, isNew] = m_bundles.try_emplace(keyName);
+    Bundle& bundle = it->second;
+    if (!isNew) {
+      return bundle;
+    }
+
+    std::vector<uint8_t> payload;
+    std::unordered_set<Name> visited;
+    for (auto cert = m_certs.find(keyName);
+         cert != m_certs.end() && visited.insert(cert->first).second;
+         cert = m_certs.find(getIssuerKeyName(cert->second))) {
+      const Block& wire = cert->second.wireEncode();
+      payload.insert(payload.end(), wire.begin(), wire.end());
+    }
+
+    bundle.versioned = Name(keyName).append(chainComponent).appendVersion();
+    uint64_t lastSeg = (payload.size() - 1) / BUNDLE_SEGMENT_SIZE;
+    for (uint64_t seg = 0; seg <= lastSeg; ++seg) {
+      size_t offset = seg * BUNDLE_SEGMENT_SIZE;
+      Data data(Name(bundle.versioned).appendSegment(seg));
+      data.setFreshnessPeriod(BUNDLE_FRESHNESS);
+      data.setFinalBlock(name::Component::fromSegment(lastSeg));
+      size_t len = std::min(BUNDLE_SEGMENT_SIZE, payload.size() - offset);
+      data.setContent(ndn::make_span(payload).subspan(offset, len));
+      m_signer.sign(data);
+      bundle.segments.push_back(std::move(data));
+    }
+    std::cout << "<B\t" << bundle.versioned << '\t' << visited.size() << std::endl;
+    return bundle;
+  }
+
+  // Determine the key name of the issuer, or return an empty name if self-signed.
+  static Name getIssuerKeyName(const Data& data) {
+    auto kl = data.getKeyLocator();
+    if (!kl || kl->getType() != tlv::Name || kl->getName().isPrefixOf(data.getName())) {
+      return Name();
+    }
+    const Name& issuer = kl->getName();
+    return Certificate::isValidName(issuer) ? ndn::security::extractKeyNameFromCertName(issuer)
+                                            : issuer;
+  }
+
+  void gatherIntermediate(const Data& data) {
+    auto issuer = data.getKeyLocator()->getName();
+    bool isCertName = Certificate::isValidName(issuer);
+    auto keyName = isCertName ? ndn::security::extractKeyNameFromCertName(issuer) : issuer;
+    if (m_serving.count(keyName) > 0 || m_fetching.count(issuer) > 0) {
+      return;
+    }
+
+    Interest interest(issuer);
+    if (!isCertName) {
+      interest.setCanBePrefix(true);
+      interest.setMustBeFresh(true);
+    }
+    interest.setInterestLifetime(FETCH_TIMEOUT);
+    fetchAdd(interest);
+  }
+
+  void fetchAdd(const Interest& interest) {
+    std::cout << "<I\t" << interest.getName() << std::endl;
+    m_fetching.emplace(interest.getName(), m_sched.schedule(FETCH_RETRY, [this, interest] {
+      std::cout << ">T\t" << interest.getName() << std::endl;
+      fetchAdd(interest);
+    }));
+    m_face.expressInterest(
+      interest,
+      [this](const Interest& interest, const Data& data) {
+        std::cout << ">D\t" << data.getName() << std::endl;
+        m_fetching.erase(interest.getName());
+
+        try {
+          Certificate cert(data);
+          if (cert.getKeyLocator()->getName().isPrefixOf(data.getName())) {
+            std::cout << "!S\t" << data.getName() << std::endl;
+            return;
+          }
+        } catch (const tlv::Error&) {
+          std::cout << "!C\t" << data.getName() << std::endl;
+          return;
+        }
+
+        add(data);
+      },
+      nullptr, nullptr);
+  }
+
+private:
+  Face& m_face;
+  CachedSigner m_signer;
+  Scheduler& m_sched;
+  Options m_opts;
+  std::unordered_map<Name, Data> m_certs;
+  std::unordered_map<Name, Bundle> m_bundles;
+  std::unordered_map<Name, ndn::ScopedRegisteredPrefixHandle> m_serving;
+  std::unordered_map<Name, ndn::scheduler::ScopedEventId> m_fetching;
+};
+
+} // namespace ndn6::serve_certs
+
+#endif // NDN6_TOOLS_SERVE_CERTS_HPP
@@ -0,0 +1,161 @@
+#include "common.hpp"
+#include "facemon.hpp"
+#include "file-server.hpp"
+#include "prefix-allocate.hpp"
+#include "prefix-proxy.hpp"
+#include "serve-certs.hpp"
+#include "unix-time.hpp"
+
+#include <fstream>
+#include <set>
+
+namespace ndn6::tools {
+
+// Resources shared by all services in the process.
+struct Context {
+  KeyChain& keyChain = getKeyChain();
+  Face face{nullptr, keyChain};
+  Scheduler sched{face.getIoContext()};
+  std::set<Name> metricsPrefixes;
+
+  void addMetrics(const Name& prefix) {
+    if (!prefix.empty()) {
+      metricsPrefixes.insert(prefix);
+    }
+  }
+};
+
+using MakeService =
+  std::function<std::unique_ptr<Service>(Context& ctx, const std::vector<std::string>& args)>;
+
+static const std::map<std::string, MakeService> SERVICES{
+  {"facemon",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = facemon::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<facemon::Facemon>(ctx.face, ctx.keyChain, ctx.sched, opts);
+   }},
+  {"file-server",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = file_server::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<file_server::FileServer>(ctx.face, ctx.keyChain, opts);
+   }},
+  {"prefix-allocate",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = prefix_allocate::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<prefix_allocate::PrefixAllocate>(ctx.face, ctx.keyChain, ctx.sched,
+                                                              opts);
+   }},
+  {"prefix-proxy",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = prefix_proxy::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<prefix_proxy::PrefixProxy>(ctx.face, ctx.keyChain, opts);
+   }},
+  {"serve-certs",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = serve_certs::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<serve_certs::ServeCerts>(ctx.face, ctx.keyChain, ctx.sched, opts);
+   }},
+  {"unix-time-service",
+   [](Context& ctx, const std::vector<std::string>& args) {
+     auto opts = unix_time::parseOptions(args);
+     ctx.addMetrics(opts.metricsPrefix);
+     return std::make_unique<unix_time::UnixTimeService>(ctx.face, ctx.keyChain, ctx.sched, opts);
+   }},
+};
+
+// Create services from a configuration file.
+// Each line is a service name followed by the command line arguments of its standalone program.
+// Empty lines and lines starting with '#' are ignored.
+static bool
+loadConfig(const std::string& filename, Context& ctx,
+           std::vector<std::unique_ptr<Service>>& services) {
+  std::ifstream file(filename);
+  if (!file) {
+    std::cerr << "cannot open " << filename << std::endl;
+    return false;
+  }
+
+  std::string line;
+  for (int lineNo = 1; std::getline(file, line); ++lineNo) {
+    auto pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos || line[pos] == '#') {
+      continue;
+    }
+
+    auto args = po::split_unix(line);
+    auto it = SERVICES.find(args.front());
+    if (it == SERVICES.end()) {
+      std::cerr << "line " << lineNo << ": unknown service " << args.front() << std::endl;
+      return false;
+    }
+    args.erase(args.begin());
+
+    try {
+      services.push_back(it->second(ctx, args));
+    } catch (const std::exception& e) {
+      std::cerr << "line " << lineNo << ": " << it->first << ": " << e.what() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char** argv) {
+  std::string configFile;
+  parseProgramOptions(
+    argc, argv,
+    "Usage: ndn6-tools services.conf\n"
+    "\n"
+    "Run several services in one process, sharing one Face and KeyChain.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("config", po::value(&configFile)->required(), "service configuration file");
+    },
+    "config", 1);
+
+  Context ctx;
+  std::vector<std::unique_ptr<Service>> services;
+  if (!loadConfig(configFile, ctx, services)) {
+    return 1;
+  }
+  if (services.empty()) {
+    std::cerr << "no service configured" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<MetricsPublisher>> metricsPublishers;
+  for (const Name& prefix : ctx.metricsPrefixes) {
+    metricsPublishers.push_back(std::make_unique<MetricsPublisher>(ctx.face, ctx.keyChain, prefix));
+  }
+
+  // enable local fields once for all services
+  auto startAll = [&] {
+    for (const auto& service : services) {
+      service->start();
+    }
+    StartupTimer::mark("started");
+  };
+  nfd::Controller controller(ctx.face, ctx.keyChain);
+  if (std::any_of(services.begin(), services.end(),
+                  [](const auto& service) { return service->needsLocalFields(); })) {
+    enableLocalFields(controller, startAll);
+  } else {
+    startAll();
+  }
+
+  ctx.face.processEvents();
+  return 0;
+}
+
+} // namespace ndn6::tools
+
+int
+main(int argc, char** argv) {
+  return ndn6::tools::main(argc, argv);
+}
@@ -1,24 +1,25 @@
 #include "common.hpp"
+#include "unix-time.hpp"
 
 namespace ndn6::unix_time_service {
 
+using unix_time::UnixTimeService;
+
 int
-main() {
-  Face face;
-  KeyChain keyChain;
-  Name prefix = "/localhop/unix-time";
-  face.setInterestFilter(
-    InterestFilter(prefix, "<>{0}"),
-    [&](const auto&, const Interest& interest) {
-      if (!interest.getCanBePrefix() || !interest.getMustBeFresh()) {
-        return;
-      }
-      Data data(Name(prefix).appendTimestamp());
-      data.setMetaInfo(ndn::MetaInfo().setFreshnessPeriod(1_ms));
-      keyChain.sign(data);
-      face.put(data);
-    },
-    abortOnRegisterFail);
+main(int argc, char** argv) {
+  auto opts = exitOnUsageError(
+    [&] { return unix_time::parseOptions(std::vector<std::string>(argv + 1, argv + argc)); });
+
+  KeyChain& keyChain = getKeyChain();
+  Face face(nullptr, keyChain);
+  Scheduler sched(face.getIoContext());
+  UnixTimeService app(face, keyChain, sched, opts);
+  std::optional<MetricsPublisher> metricsPublisher;
+  if (!opts.metricsPrefix.empty()) {
+    metricsPublisher.emplace(face, keyChain, opts.metricsPrefix);
+  }
+  app.start();
+  StartupTimer::mark("started");
   face.processEvents();
   return 0;
 }
@@ -27,5 +28,5 @@ main() {
 
 int
 main(int argc, char** argv) {
-  return ndn6::unix_time_service::main();
+  return ndn6::unix_time_service::main(argc, argv);
 }
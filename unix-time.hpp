@@ -0,0 +1,244 @@
+#ifndef NDN6_TOOLS_UNIX_TIME_HPP
+#define NDN6_TOOLS_UNIX_TIME_HPP
+
+#include "common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ndn6::unix_time {
+
+// Pre-signed UnixTime answers at a fixed granularity.
+// Time is divided into ticks. The answer for a tick carries the tick start time, so that the
+// timestamp error is less than one tick. An answer is signed once and served to every query in
+// the same tick. Optionally, a background thread signs answers for upcoming ticks, using its
+// own KeyChain instance because KeyChain is not thread-safe.
+class PresignedAnswers : boost::noncopyable {
+public:
+  using KeyChainFactory = std::function<std::unique_ptr<KeyChain>()>;
+
+  explicit PresignedAnswers(KeyChain& keyChain, const SigningInfo& si, const Name& prefix,
+                            time::milliseconds granularity)
+    : m_keyChain(keyChain)
+    , m_si(si)
+    , m_prefix(prefix)
+    , m_granularity(std::max(granularity, time::milliseconds(1)))
+    , m_ring(2) {}
+
+  ~PresignedAnswers() {
+    stopAhead();
+  }
+
+  // Start a background thread that signs answers up to nAhead ticks in the future.
+  void startAhead(size_t nAhead, const KeyChainFactory& makeKeyChain) {
+    stopAhead();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_ring.assign(nAhead + 2, Slot{});
+    }
+    m_stop = false;
+    m_thread = std::thread(
+      [this, nAhead, keyChain = makeKeyChain()] { runAhead(*keyChain, nAhead); });
+  }
+
+  void stopAhead() {
+    if (!m_thread.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+  }
+
+  int64_t getTick(time::system_clock::time_point t) const {
+    return time::duration_cast<time::milliseconds>(t.time_since_epoch()).count() /
+           m_granularity.count();
+  }
+
+  time::system_clock::time_point getTickTime(int64_t tick) const {
+    return time::system_clock::time_point(tick * m_granularity);
+  }
+
+  // Return the answer of the tick containing now, signing it in the calling thread if needed.
+  std::shared_ptr<const Data> get(time::system_clock::time_point now = time::system_clock::now()) {
+    int64_t tick = getTick(now);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const Slot& slot = m_ring[tick % m_ring.size()];
+      if (slot.tick == tick) {
+        return slot.data;
+      }
+    }
+
+    ++m_nSignedInline;
+    auto data = makeAnswer(m_keyChain, tick);
+    store(tick, data);
+    return data;
+  }
+
+  // Number of answers signed in the calling thread of get().
+  uint64_t getSignedInlineCount() const {
+    return m_nSignedInline;
+  }
+
+  // Number of answers signed by the background thread.
+  uint64_t getSignedAheadCount() const {
+    return m_nSignedAhead;
+  }
+
+private:
+  struct Slot {
+    int64_t tick = -1;
+    std::shared_ptr<const Data> data;
+  };
+
+  std::shared_ptr<const Data> makeAnswer(KeyChain& keyChain, int64_t tick) const {
+    auto data = std::make_shared<Data>(Name(m_prefix).appendTimestamp(getTickTime(tick)));
+    data->setMetaInfo(ndn::MetaInfo().setFreshnessPeriod(1_ms));
+    keyChain.sign(*data, m_si);
+    data->wireEncode();
+    return data;
+  }
+
+  void store(int64_t tick, std::shared_ptr<const Data> data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot& slot = m_ring[tick % m_ring.size()];
+    if (slot.tick < tick) {
+      slot.tick = tick;
+      slot.data = std::move(data);
+    }
+  }
+
+  void runAhead(KeyChain& keyChain, size_t nAhead) {
+    int64_t next = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+      auto now = time::system_clock::now();
+      int64_t current = getTick(now);
+      next = std::max(next, current + 1);
+      if (next > current + static_cast<int64_t>(nAhead)) {
+        auto wait = time::duration_cast<time::microseconds>(getTickTime(current + 1) - now);
+        m_cv.wait_for(lock, std::chrono::microseconds(wait.count()));
+        continue;
+      }
+
+      lock.unlock();
+      auto data = makeAnswer(keyChain, next);
+      store(next, std::move(data));
+      ++m_nSignedAhead;
+      ++next;
+      lock.lock();
+    }
+  }
+
+private:
+  KeyChain& m_keyChain;
+  SigningInfo m_si;
+  Name m_prefix;
+  time::milliseconds m_granularity;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<Slot> m_ring; // protected by m_mutex
+  bool m_stop = false;      // protected by m_mutex
+  std::thread m_thread;
+
+  uint64_t m_nSignedInline = 0;
+  std::atomic<uint64_t> m_nSignedAhead{0};
+};
+
+struct Options {
+  int granularity = 0;
+  size_t signAhead = 0;
+  Name metricsPrefix;
+};
+
+inline Options
+parseOptions(const std::vector<std::string>& args) {
+  Options opts;
+  parseProgramOptions(
+    args,
+    "Usage: ndn6-unix-time-service\n"
+    "\n"
+    "Answer queries of current Unix timestamp.\n"
+    "\n",
+    [&](auto addOption) {
+      addOption("granularity", po::value(&opts.granularity),
+                "pre-sign answers at this granularity (milliseconds), 0 signs every answer");
+      addOption("sign-ahead", po::value(&opts.signAhead),
+                "sign answers for this many upcoming ticks on a background thread");
+      addOption("metrics-prefix", po::value(&opts.metricsPrefix),
+                "publish metrics under this prefix");
+    });
+  return opts;
+}
+
+class UnixTimeService : public Service {
+public:
+  explicit UnixTimeService(Face& face, KeyChain& keyChain, Scheduler& sched, const Options& opts)
+    : m_face(face)
+    , m_keyChain(keyChain)
+    , m_signer(keyChain)
+    , m_sched(sched)
+    , m_opts(opts) {}
+
+  void start() override {
+    if (m_opts.granularity > 0) {
+      m_presigned.emplace(m_keyChain, SigningInfo(), m_prefix,
+                          time::milliseconds(m_opts.granularity));
+      if (m_opts.signAhead > 0) {
+        m_presigned->startAhead(m_opts.signAhead, [] { return std::make_unique<KeyChain>(); });
+      } else {
+        refresh();
+      }
+    }
+
+    m_face.setInterestFilter(InterestFilter(m_prefix, "<>{0}"),
+                             std::bind(&UnixTimeService::answer, this, _2), abortOnRegisterFail);
+  }
+
+private:
+  // sign the answer at the start of each tick
+  void refresh() {
+    auto now = time::system_clock::now();
+    m_presigned->get(now);
+    m_refreshTimer = m_sched.schedule(m_presigned->getTickTime(m_presigned->getTick(now) + 1) - now,
+                                      [this] { refresh(); });
+  }
+
+  void answer(const Interest& interest) {
+    if (!interest.getCanBePrefix() || !interest.getMustBeFresh()) {
+      return;
+    }
+    m_nAnswers.inc();
+    if (m_presigned) {
+      m_face.put(*m_presigned->get());
+      return;
+    }
+    Data data(Name(m_prefix).appendTimestamp());
+    data.setMetaInfo(ndn::MetaInfo().setFreshnessPeriod(1_ms));
+    m_signer.sign(data);
+    m_face.put(data);
+  }
+
+private:
+  Face& m_face;
+  KeyChain& m_keyChain;
+  CachedSigner m_signer;
+  Scheduler& m_sched;
+  Options m_opts;
+  Name m_prefix = "/localhop/unix-time";
+  std::optional<PresignedAnswers> m_presigned;
+  ndn::scheduler::ScopedEventId m_refreshTimer;
+  Metrics::Counter m_nAnswers = Metrics::get().counter("answers-served");
+};
+
+} // namespace ndn6::unix_time
+
+#endif // NDN6_TOOLS_UNIX_TIME_HPP